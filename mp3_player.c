@@ -1,12 +1,483 @@
 #include <gtk/gtk.h>
 #include <gst/gst.h>
+#include <gst/pbutils/pbutils.h>
+#include <gst/controller/controller.h>
+#include <gst/base/gstbaseparse.h>
+#include <glib/gstdio.h>
+#include <glib-unix.h>
+#include <gio/gunixsocketaddress.h>
+#include <signal.h>
+#include <stdio.h>
+#include <math.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <time.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+/* Playlist modelinin sütunları */
+enum {
+    PLAYLIST_COL_ICON,       // Satır ikonu
+    PLAYLIST_COL_NAME,       // Görünen ad (etiket varsa "Sanatçı - Başlık", yoksa dosya adı)
+    PLAYLIST_COL_DURATION,   // Süre ("d:ss"), bilinmiyorsa boş
+    PLAYLIST_COL_BACKGROUND, // Çalan satırın arkaplan rengi (diğer satırlar için NULL)
+    PLAYLIST_N_COLUMNS
+};
+
+/* Çalan satırın vurgu rengi (eski ".selected-row" CSS sınıfı ile aynı) */
+#define PLAYLIST_SELECTED_ROW_COLOR "#d0e0ff"
+
+/* PlaylistStore üzerinde çalışan sanal playlist modeli (aşağıda tanımlı) */
+#define PLAYLIST_TYPE_MODEL (playlist_model_get_type())
+G_DECLARE_FINAL_TYPE(PlaylistModel, playlist_model, PLAYLIST, MODEL, GObject)
+
+/*
+ * Parça geçişlerindeki sessizliği ölçmek için sink pad probe durumu.
+ * Yalnızca streaming thread'inde (probe içinde) değiştirilir; diğer
+ * thread'ler sıfırlamayı reset_pending ile ister, probe bir sonraki
+ * çağrıda uygular.
+ */
+typedef struct {
+    GstSegment   segment;       // Sink'e gelen son segment
+    GstClockTime last_end;      // Son buffer'ın bittiği an (running-time)
+    gboolean     track_changed; // STREAM_START görüldü, yeni parçanın ilk buffer'ı bekleniyor
+    gint         reset_pending; // Ölçümü sıfırla (atomik; kontrol thread'i kurar)
+} GapProbe;
+
+/*
+ * Çalma hattı ölçümleri ("İstatistikler" bölümünde doldurulur).
+ * decoder_* alanları streaming thread'lerinden, state_* alanları kontrol
+ * thread'inden de yazıldığı için lock ile korunur; diğerleri yalnızca ana
+ * thread'de değişir.
+ */
+typedef struct {
+    GMutex       lock;
+    GHashTable  *decoder_threads;   // GThread -> son buffer'daki thread CPU saati (ns)
+    gint64       decoder_cpu_ns;    // Decoder thread'lerinin toplam CPU zamanı
+
+    gint64       state_requested;   // Bekleyen durum isteğinin zamanı (µs, 0: yok)
+    GstState     state_target;
+    guint        state_changes;
+    gdouble      state_last_ms, state_max_ms;
+
+    gint64       seek_requested;    // Tamamlanmamış seek'in zamanı (µs, 0: yok)
+    guint32      seek_seqnum;       // O seek olayının sıra numarası (ASYNC_DONE ile eşlenir)
+    guint        seeks;
+    gdouble      seek_last_ms, seek_max_ms;
+
+    guint        buffering_events;
+    gint         buffering_percent;
+    guint        underruns;         // Çalarken tamponun %100'ün altına düşmesi
+
+    guint        qos_events;
+    guint        late_buffers;      // Sink'e geç ulaşan buffer'lar (pozitif jitter)
+    guint64      dropped_buffers;   // QoS mesajlarının bildirdiği en yüksek atılan buffer sayısı
+    gdouble      max_jitter_ms;
+
+    gint64       sample_wall, sample_cpu, sample_decoder; // Son örneğin zamanları
+    gdouble      cpu_percent;         // Son aralıkta işlemin CPU kullanımı
+    gdouble      decoder_cpu_percent; // Son aralıkta decoder thread'lerinin CPU kullanımı
+    gdouble      sink_latency_ms;     // Ses sink'inin ölçülen çıkış gecikmesi (-1: bilinmiyor)
+
+    FILE        *log;               // Periyodik kayıt (yoksa NULL)
+    gboolean     log_csv;           // TRUE: CSV, FALSE: satır başına bir JSON nesnesi
+} PlayerStats;
+
+/* Kontrol thread'ine giden çalma komutu ("Çalma kontrolü" bölümü) */
+typedef enum {
+    CONTROL_STOP,  // Pipeline NULL'a
+    CONTROL_LOAD,  // NULL'a, ardından yeni URI ve kazanç
+    CONTROL_PLAY,
+    CONTROL_PAUSE
+} ControlType;
+
+typedef struct _ControlCommand ControlCommand;
+struct _ControlCommand {
+    ControlCommand *next;
+    ControlType     type;
+    gchar          *uri;        // CONTROL_LOAD
+    gdouble         gain;       // CONTROL_LOAD
+    guint           generation; // CONTROL_LOAD/CONTROL_STOP: komutun nesli
+};
+
+/*
+ * Komut kuyruğu: üreticiler (ana thread) komutları kilitsiz bir yığına
+ * CAS ile ekler, kontrol thread'i yığını tek atomik değişimle boşaltır.
+ * wake_lock yalnızca kuyruk boşken uyumak ve sync için kullanılır.
+ */
+typedef struct {
+    GThread        *thread;
+    ControlCommand *head;      // En yeni komut başta
+    gint            pushed;    // Eklenen komut sayısı (atomik)
+    gint            done;      // İşlenen komut sayısı (atomik; wake_lock altında artar)
+    guint           executed;  // Birleştirildikten sonra pipeline'a uygulanan geçişler
+    gboolean        quit;      // Kapanış istendi (wake_lock altında)
+    guint           generation; // Her yükleme/durdurmada artar (ana thread)
+    gint            applied;    // Pipeline'ın NULL'a inip ulaştığı son nesil (atomik)
+    GMutex          wake_lock;
+    GCond           wake;      // Kuyruğa komut geldi
+    GCond           idle;      // Kuyruk boşaldı
+} PlayerControl;
+
+/* Çalma kuyruğu: kullanıcının kuyruğu, karışık çalma ve tekrar (aşağıda açıklanmış) */
+typedef struct {
+    gboolean    shuffle;
+    gboolean    repeat_one;
+    GQueue      upcoming;  // Kullanıcının sıraya eklediği konumlar (GINT_TO_POINTER)
+    GArray     *history;   // Karışık çalmada çalınan ve çekilen konumlar (gint)
+    guint       cursor;    // history'de çalan parçanın yeri
+    GHashTable *at_slot;   // Permütasyon: slot -> konum (yalnızca değişenler)
+    GHashTable *slot_of;   // Ters permütasyon: konum -> slot
+    gint        drawn;     // Bu turda çekilen parça sayısı (permütasyonun başı)
+    gint        anchor;    // Karışık değilken playlist sırasında kalınan yer
+    gint        current;   // Kuyruğun son gördüğü çalan parça (-1: yok)
+    guint       revision;  // Uyulan playlist revizyonu
+    GRand      *rand;
+} PlayQueue;
+
+/*
+ * ---- Playlist deposu ----
+ * Tüm metinler (yol, URI, etiketler) 64 KB'lık arena bloklarında tutulur;
+ * bloklar hiç taşınmaz ve liste temizlenince topluca serbest bırakılır.
+ * Kayıtlar eklendikleri sırada "entries" dizisinde durur, çalma sırası ise
+ * "order" dizisindeki kayıt numaralarıdır. Böylece ekleme ve silme yalnızca
+ * 4 baytlık numaraları kaydırır; metinler kopyalanmaz.
+ */
+
+#define PLAYLIST_ARENA_BLOCK (64 * 1024)
+
+/* Playlistteki bir parçanın kaydı */
+typedef struct {
+    const gchar *path;      // Arenada, tam dosya yolu
+    const gchar *uri;       // Arenada; ilk ihtiyaçta hesaplanır (NULL: henüz yok)
+    const gchar *title;     // Etiketler (klasör taramasından; yoksa NULL)
+    const gchar *artist;
+    GstClockTime duration;  // Bilinmiyorsa GST_CLOCK_TIME_NONE
+    guint32      base_off;  // path içinde dosya adının başladığı yer
+} PlaylistEntry;
+
+typedef struct {
+    GPtrArray *blocks;      // Arena blokları
+    gsize      block_size;  // Son bloğun boyutu
+    gsize      block_used;  // Son blokta kullanılan bayt
+    GArray    *entries;     // PlaylistEntry, eklenme sırasıyla
+    GArray    *order;       // guint32 kayıt numaraları, çalma sırasıyla
+    GPtrArray *mappings;    // Metinleri doğrudan kullanılan eşlenmiş dosyalar (oturum)
+    guint      generation;  // Her temizlemede artar (kayıt numaraları yeniden kullanılır)
+    guint      revision;    // Konumları kaydıran her değişiklikte artar (sona ekleme hariç)
+} PlaylistStore;
+
+static PlaylistStore *playlist_store_new(void) {
+    PlaylistStore *store = g_new0(PlaylistStore, 1);
+    store->blocks = g_ptr_array_new_with_free_func(g_free);
+    store->mappings = g_ptr_array_new_with_free_func((GDestroyNotify)g_mapped_file_unref);
+    store->entries = g_array_new(FALSE, FALSE, sizeof(PlaylistEntry));
+    store->order = g_array_new(FALSE, FALSE, sizeof(guint32));
+    return store;
+}
+
+/* Tüm kayıtları ve arenayı boşaltır (dizilerin kapasitesi korunur) */
+static void playlist_store_clear(PlaylistStore *store) {
+    g_ptr_array_set_size(store->blocks, 0);
+    g_ptr_array_set_size(store->mappings, 0);
+    store->block_size = 0;
+    store->block_used = 0;
+    g_array_set_size(store->entries, 0);
+    g_array_set_size(store->order, 0);
+    store->generation++;
+    store->revision++;
+}
+
+/* Metni arenaya kopyalar; NULL için NULL döner */
+static const gchar *playlist_store_intern(PlaylistStore *store, const gchar *text) {
+    if (!text)
+        return NULL;
+
+    gsize size = strlen(text) + 1;
+    if (store->block_used + size > store->block_size) {
+        store->block_size = MAX(PLAYLIST_ARENA_BLOCK, size);
+        store->block_used = 0;
+        g_ptr_array_add(store->blocks, g_malloc(store->block_size));
+    }
+
+    gchar *copy = (gchar *)g_ptr_array_index(store->blocks, store->blocks->len - 1) + store->block_used;
+    memcpy(copy, text, size);
+    store->block_used += size;
+    return copy;
+}
+
+static inline int playlist_store_count(const PlaylistStore *store) {
+    return (int)store->order->len;
+}
+
+/* Çalma sırasındaki position'daki kayıt */
+static inline PlaylistEntry *playlist_store_get(const PlaylistStore *store, int position) {
+    guint32 id = g_array_index(store->order, guint32, position);
+    return &g_array_index(store->entries, PlaylistEntry, id);
+}
+
+static inline const gchar *playlist_store_path(const PlaylistStore *store, int position) {
+    return playlist_store_get(store, position)->path;
+}
+
+static inline const gchar *playlist_store_basename(const PlaylistStore *store, int position) {
+    PlaylistEntry *entry = playlist_store_get(store, position);
+    return entry->path + entry->base_off;
+}
+
+/* Kaydın URI'si; ilk çağrıda hesaplanıp arenaya yazılır (yalnızca ana thread) */
+static const gchar *playlist_store_uri(PlaylistStore *store, int position) {
+    PlaylistEntry *entry = playlist_store_get(store, position);
+
+    if (!entry->uri) {
+        gchar *uri = g_filename_to_uri(entry->path, NULL, NULL);
+        entry->uri = playlist_store_intern(store, uri);
+        g_free(uri);
+    }
+    return entry->uri;
+}
+
+/* position'a yeni bir parça ekler (position == sayı ise sona); metinler arenaya kopyalanır */
+static void playlist_store_insert(PlaylistStore *store, int position, const gchar *path,
+                                  const gchar *title, const gchar *artist, GstClockTime duration) {
+    PlaylistEntry entry;
+    const gchar *slash;
+    guint32 id = store->entries->len;
+
+    entry.path = playlist_store_intern(store, path);
+    entry.uri = NULL;
+    entry.title = playlist_store_intern(store, title);
+    entry.artist = playlist_store_intern(store, artist);
+    entry.duration = duration;
+    slash = strrchr(entry.path, G_DIR_SEPARATOR);
+    entry.base_off = slash && slash[1] ? (guint32)(slash + 1 - entry.path) : 0;
+
+    g_array_append_val(store->entries, entry);
+    if (position >= playlist_store_count(store)) {
+        g_array_append_val(store->order, id);
+    } else {
+        g_array_insert_val(store->order, position, id);
+        store->revision++;
+    }
+}
+
+static inline void playlist_store_append(PlaylistStore *store, const gchar *path, const gchar *title,
+                                         const gchar *artist, GstClockTime duration) {
+    playlist_store_insert(store, playlist_store_count(store), path, title, artist, duration);
+}
+
+/* Eşlenmiş dosyayı depoya bağlar; metinleri depo temizlenene kadar geçerli kalır */
+static void playlist_store_adopt(PlaylistStore *store, GMappedFile *file) {
+    g_ptr_array_add(store->mappings, file);
+}
+
+/* Hazır bir kaydı kopyalamadan sona ekler (metinler arenada ya da bağlı bir eşlemede olmalı) */
+static void playlist_store_append_entry(PlaylistStore *store, const PlaylistEntry *entry) {
+    guint32 id = store->entries->len;
+
+    g_array_append_val(store->entries, *entry);
+    g_array_append_val(store->order, id);
+}
+
+/* remove[konum] TRUE olan parçaları tek geçişte sıradan çıkarır */
+static void playlist_store_remove_marked(PlaylistStore *store, const gboolean *remove) {
+    guint32 *order = (guint32 *)store->order->data;
+    guint kept = 0;
+
+    for (guint i = 0; i < store->order->len; i++) {
+        if (!remove[i])
+            order[kept++] = order[i];
+    }
+    g_array_set_size(store->order, kept);
+    store->revision++;
+}
+
+/*
+ * ---- Arama indeksi ----
+ * Her kaydın aranabilir metni (sanatçı, başlık ve dosya adı; küçük harfe
+ * katlanmış) tek bir tamponda durur. Metindeki her 3 baytlık parça
+ * (trigram) için onu içeren kayıt numaraları artan sırada saklanır. Sorgu,
+ * kelimelerinin trigram listelerinden en kısasını aday kümesi olarak alır,
+ * yalnızca bu adayları metinde doğrular ve kayıt numarası -> konum
+ * tablosuyla çalma sırasına çevirir; böylece tuş başına iş playlist
+ * boyutuna değil aday sayısına bağlıdır. Kayıtlar yalnızca sona eklendiği
+ * için indeks, her sorgudan önce yalnızca yeni kayıtlarla büyütülür; konum
+ * tablosu ise yalnızca sıra değiştiğinde (revision) yeniden kurulur.
+ */
+
+typedef struct {
+    GString    *text;       // Kayıtların metinleri, '\0' ile ayrılmış
+    GArray     *offsets;    // Kayıt numarası -> text içindeki başlangıç (guint32)
+    GHashTable *grams;      // Trigram anahtarı -> GArray (guint32 kayıt numaraları, artan)
+    GArray     *positions;  // Kayıt numarası -> çalma sırasındaki konum (G_MAXUINT32: sırada yok)
+    guint       positioned; // positions'ın kapsadığı sıra uzunluğu
+    guint       revision;   // positions'ın kurulduğu PlaylistStore revizyonu
+    guint       generation; // İndekslenen PlaylistStore neslinin numarası
+} SearchIndex;
+
+static void search_gram_list_free(gpointer p) {
+    g_array_free(p, TRUE);
+}
+
+static SearchIndex *search_index_new(void) {
+    SearchIndex *index = g_new0(SearchIndex, 1);
+    index->text = g_string_new(NULL);
+    index->offsets = g_array_new(FALSE, FALSE, sizeof(guint32));
+    index->grams = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, search_gram_list_free);
+    index->positions = g_array_new(FALSE, FALSE, sizeof(guint32));
+    return index;
+}
+
+static inline guint32 search_gram_key(const gchar *p) {
+    return ((guint32)(guchar)p[0] << 16) | ((guint32)(guchar)p[1] << 8) | (guchar)p[2];
+}
+
+/* Depoya sonradan eklenen kayıtları indekse katar; depo temizlendiyse baştan kurar */
+static void search_index_update(SearchIndex *index, const PlaylistStore *store) {
+    if (index->generation != store->generation) {
+        g_string_truncate(index->text, 0);
+        g_array_set_size(index->offsets, 0);
+        g_hash_table_remove_all(index->grams);
+        index->generation = store->generation;
+    }
+
+    // Konum tablosu: sıra değiştiyse baştan, yalnızca sona eklendiyse yeni konumlar
+    const guint32 *order = (const guint32 *)store->order->data;
+    if (index->revision != store->revision || index->positioned > store->order->len) {
+        index->revision = store->revision;
+        index->positioned = 0;
+        g_array_set_size(index->positions, 0);
+    }
+    guint old_size = index->positions->len;
+    g_array_set_size(index->positions, store->entries->len);
+    for (guint id = old_size; id < store->entries->len; id++)
+        g_array_index(index->positions, guint32, id) = G_MAXUINT32;
+    for (guint position = index->positioned; position < store->order->len; position++)
+        g_array_index(index->positions, guint32, order[position]) = position;
+    index->positioned = store->order->len;
+
+    GString *raw = g_string_new(NULL);
+    for (guint id = index->offsets->len; id < store->entries->len; id++) {
+        const PlaylistEntry *entry = &g_array_index(store->entries, PlaylistEntry, id);
+
+        g_string_truncate(raw, 0);
+        if (entry->artist)
+            g_string_append_printf(raw, "%s ", entry->artist);
+        if (entry->title)
+            g_string_append_printf(raw, "%s ", entry->title);
+        g_string_append(raw, entry->path + entry->base_off);
+
+        gchar *folded = g_utf8_casefold(raw->str, raw->len);
+        guint32 offset = (guint32)index->text->len;
+        g_array_append_val(index->offsets, offset);
+        g_string_append_len(index->text, folded, strlen(folded) + 1);
+
+        for (const gchar *p = folded; p[0] && p[1] && p[2]; p++) {
+            gpointer key = GUINT_TO_POINTER(search_gram_key(p));
+            GArray *ids = g_hash_table_lookup(index->grams, key);
+
+            if (!ids) {
+                ids = g_array_new(FALSE, FALSE, sizeof(guint32));
+                g_hash_table_insert(index->grams, key, ids);
+            }
+            // Aynı kayıttaki tekrar eden trigramlar bir kez sayılır
+            if (ids->len == 0 || g_array_index(ids, guint32, ids->len - 1) != id)
+                g_array_append_val(ids, id);
+        }
+        g_free(folded);
+    }
+    g_string_free(raw, TRUE);
+}
+
+static gint search_compare_positions(gconstpointer a, gconstpointer b) {
+    guint32 x = *(const guint32 *)a, y = *(const guint32 *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Kaydın metni query'deki tüm kelimeleri içeriyor mu */
+static gboolean search_index_matches(const SearchIndex *index, guint32 id, gchar **words) {
+    const gchar *text = index->text->str + g_array_index(index->offsets, guint32, id);
+
+    for (int w = 0; words[w]; w++) {
+        if (*words[w] && !strstr(text, words[w]))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+/* query'deki tüm kelimeleri içeren parçaların çalma sırasındaki konumlarını (artan) positions'a yazar */
+static void search_index_query(SearchIndex *index, const PlaylistStore *store,
+                               const gchar *query, GArray *positions) {
+    gchar *folded = g_utf8_casefold(query, -1);
+    gchar **words = g_strsplit_set(folded, " \t", -1);
+    GArray *best = NULL;
+    gboolean empty = FALSE;
+
+    search_index_update(index, store);
+    g_array_set_size(positions, 0);
+
+    // Aday kümesi: kelimelerin trigram listelerinin en kısası
+    for (int w = 0; words[w] && !empty; w++) {
+        for (const gchar *p = words[w]; p[0] && p[1] && p[2]; p++) {
+            GArray *ids = g_hash_table_lookup(index->grams, GUINT_TO_POINTER(search_gram_key(p)));
+            if (!ids) {
+                empty = TRUE;
+                break;
+            }
+            if (!best || ids->len < best->len)
+                best = ids;
+        }
+    }
+
+    if (!empty && best) {
+        // Yalnızca en kısa listedeki adaylar doğrulanır, sonuç sıraya göre dizilir
+        for (guint i = 0; i < best->len; i++) {
+            guint32 id = g_array_index(best, guint32, i);
+            guint32 position = g_array_index(index->positions, guint32, id);
+
+            if (position != G_MAXUINT32 && search_index_matches(index, id, words))
+                g_array_append_val(positions, position);
+        }
+        g_array_sort(positions, search_compare_positions);
+    } else if (!empty) {
+        // Trigramı olmayan kısa sorgu: tüm liste taranır
+        int count = playlist_store_count(store);
+        for (int position = 0; position < count; position++) {
+            guint32 id = g_array_index(store->order, guint32, position);
+            if (search_index_matches(index, id, words)) {
+                guint32 value = (guint32)position;
+                g_array_append_val(positions, value);
+            }
+        }
+    }
+
+    g_strfreev(words);
+    g_free(folded);
+}
+
+/* Arkaplanda süren klasör taraması (aşağıda tanımlı) */
+typedef struct _LibraryScan LibraryScan;
+
+/* İki deck'li geçiş (crossfade) motoru (aşağıda tanımlı) */
+typedef struct _Crossfade Crossfade;
+
+/* Arkaplanda süren ses yüksekliği analizi (aşağıda tanımlı) */
+typedef struct _LoudnessAnalysis LoudnessAnalysis;
+
+/* Arkaplanda süren kopya parça analizi (aşağıda tanımlı) */
+typedef struct _DuplicateAnalysis DuplicateAnalysis;
 
 /* Uygulama boyunca tutacağımız veriler */
 typedef struct {
-    GstElement *pipeline;
+    GstElement *pipeline;      // Etkin çalma pipeline'ı: playbin ya da crossfade motorunun pipeline'ı
+    GstElement *playbin;       // Normal (ve boşluksuz) çalma için playbin
+    gchar      *audio_sink_name; // Ses sink'inin fabrika adı (crossfade motoru da kullanır)
 
-    /* Arayüz bileşenleri */
+    /* Arayüz bileşenleri (headless modda hepsi NULL) */
+    GtkWidget  *window;
     GtkWidget  *play_button;
     GtkWidget  *slider;
     GtkWidget  *previous_label;
@@ -15,358 +486,5629 @@ typedef struct {
     GtkWidget  *previous_button;
     GtkWidget  *next_button;
     GtkWidget  *time_label;   // Süre gösteren label
-    GtkWidget  *playlist_box; // Playlisti göstermek için GtkListBox
+    GtkWidget  *playlist_view; // Playlisti göstermek için GtkTreeView
+    GtkWidget  *search_entry;  // Yazdıkça listeyi süzen arama kutusu
     GtkWidget  *loop_toggle;  // Döngü (loop) seçeneğini aç/kapatmak için ToggleButton
+    GtkWidget  *gapless_toggle; // Boşluksuz geçiş seçeneği için ToggleButton
+    GtkWidget  *crossfade_toggle; // Geçiş (crossfade) modu için ToggleButton
+    GtkWidget  *crossfade_spin;   // Geçiş süresi (saniye)
+    GtkWidget  *queue_menu;       // Playlist satırının sağ tık menüsü (kuyruğa ekleme)
+    int         queue_menu_position; // Menünün açıldığı satırın konumu
 
     /* Veri tutucu alanlar */
-    gchar     **file_list;
-    int         file_count;
+    PlaylistModel *playlist_model;
+    PlaylistStore *playlist;   // Parçalar, çalma sırasıyla
+    SearchIndex   *search_index;   // Arama kutusu için trigram indeksi (ilk aramada oluşturulur)
+    GArray        *search_results; // Süzgeçten geçen konumlar (guint32, artan)
+    GArray        *search_previous; // Bir önceki süzgeç (görünüme fark bildirilirken)
     int         current_index;
+    int         highlighted_index; // Vurgusu çizilmiş olan satır
     gboolean    is_playing;
     gboolean    loop_enabled; // Döngü aktif mi?
+    gboolean    hold_on_eos;  // Parça bitince sonrakine geçilmez (benchmark ölçümleri)
+
+    /*
+     * Boşluksuz (gapless) geçiş: ana thread bir sonraki parçanın URI'sini
+     * hazırlar, playbin "about-to-finish" sinyalinde (streaming thread) onu
+     * kuyruğa alır. Alanlar gapless_lock ile korunur.
+     */
+    gboolean    gapless_enabled;
+    GMutex      gapless_lock;
+    gchar      *gapless_uri;   // about-to-finish'te kuyruğa alınacak URI
+    int         gapless_index; // gapless_uri'nin playlist indeksi
+    int         queued_index;  // Kuyruğa alınmış, henüz başlamamış parça (-1: yok)
+    gdouble     gapless_gain;  // gapless_uri'nin normalizasyon kazancı
+    gdouble     queued_gain;   // Kuyruktaki parçanın kazancı (STREAM_START'ta uygulanır)
+
+    /* Sıradaki parçaların page cache'e önden okunması (prefetch_lock ile korunur) */
+    GThreadPool *prefetch_pool;   // Tek işçi (ilk ihtiyaçta oluşturulur)
+    GMutex       prefetch_lock;
+    GHashTable  *prefetch_state;  // Penceredeki yol -> PREFETCH_QUEUED / PREFETCH_DONE
+    guint64      prefetch_hits;   // Önden okunmuş olarak yüklenen parçalar
+    guint64      prefetch_misses; // Okuması bitmeden yüklenen parçalar
+    guint64      prefetch_bytes;  // Önden okunan toplam bayt
+
+    PlayerControl control;     // playbin durum değişimlerini uygulayan kontrol thread'i
+    PlayQueue     queue;       // Sonraki/önceki parçanın seçimi
+    PlayerStats  stats;        // Çalma hattı ölçümleri
+    GtkWidget   *stats_expander; // İstatistik paneli (kapalıyken güncellenmez)
+    GtkWidget   *stats_label;
+
+    GapProbe     gap_probe;
+    GstClockTime last_gap;     // Son geçişteki sessizlik
+    GstClockTime max_gap;      // Oturumdaki en uzun geçiş sessizliği
+
+    /* Geçiş (crossfade) modu: açıkken pipeline, crossfade motorunun pipeline'ıdır */
+    gboolean    crossfade_enabled;
+    Crossfade  *crossfade;     // İlk açılışta oluşturulur (yoksa NULL)
+
+    /*
+     * Seek denetimi: yalnızca kullanıcı hareketleri seek üretir ve
+     * sürükleme sırasında kare (frame) başına en fazla bir seek yapılır.
+     */
+    gboolean    seek_dragging; // Kullanıcı slider'ı sürüklüyor
+    gboolean    seek_pending;  // Sıradaki karede yapılacak seek var
+    gdouble     seek_target;   // Bekleyen seek hedefi (saniye)
+    guint       seek_tick_id;  // Bekleyen seek için tick callback (yoksa 0)
+    guint64     seek_count;    // Pipeline'a gönderilen toplam seek sayısı
+
+    /*
+     * Konum güncellemesi: slider'ın frame clock'una bağlı tek bir tick
+     * callback. Yalnızca çalarken ve pencere görünürken kayıtlıdır.
+     */
+    guint        position_tick_id;  // Kayıtlı tick callback (yoksa 0)
+    gint64       position_updated;  // Son güncellemenin frame zamanı (µs)
+    gboolean     window_hidden;     // Pencere simge durumunda ya da gizli
+    GstClockTime duration;          // Parça süresi önbelleği (DURATION_CHANGED ile geçersizlenir)
+    GstClockTime restore_position;  // Preroll bitince yapılacak seek: oturumdan ya da yükleme uygulanmadan istenen (yoksa NONE)
+
+    /*
+     * Ses yüksekliği normalizasyonu: parçaların ölçülmüş kazancı playbin'in
+     * audio-filter'ı olan volume elemanıyla uygulanır (buffer başına analiz yok).
+     */
+    gboolean          normalize_enabled;
+    GstElement       *normalize_volume; // playbin audio-filter'ı (yoksa NULL)
+    GMutex            loudness_lock;    // loudness_index'i korur (işçiler okur, ana thread yazar)
+    GHashTable       *loudness_index;   // yol -> LoudnessEntry, diskteki önbellek
+    LoudnessAnalysis *loudness_analysis; // Süren analiz (yoksa NULL)
+    gint              eq_preset;        // Ekolayzer ön ayarı (eq_presets indeksi, atomik)
+
+    /* Kopya parça tespiti */
+    GMutex             fingerprint_lock;   // fingerprint_index'i korur (işçiler okur, ana thread yazar)
+    GHashTable        *fingerprint_index;  // yol -> FingerprintEntry; ilk analizde diskten yüklenir
+    DuplicateAnalysis *duplicate_analysis; // Süren analiz (yoksa NULL)
+    GHashTable        *duplicates;         // Son analizin sonucu: yol -> kümenin ilk yolu (yoksa NULL)
+
+    /* Slider'ın arkasındaki dalga formu özeti */
+    GThreadPool     *waveform_pool;       // Arkaplanda özet hesaplayan tek işçi
+    gint             waveform_generation; // Son isteğin numarası; eskiyen işler atlanır (atomik)
+    gchar           *waveform_path;       // Özeti istenen parça
+    gint8           *waveform_peaks;      // WAVEFORM_BINS x (min, max); hazır değilse NULL
+    cairo_surface_t *waveform_surface;    // Çizilmiş özet (boyut değişince yeniden çizilir)
+
+    /* VBR MP3'lerde hızlı ve doğru seek için çerçeve indeksleri */
+    GThreadPool *seek_index_pool; // İndeksi okuyan/kuran tek işçi
+    GMutex       seek_index_lock; // seek_indexes'i korur (streaming thread'ler de okur)
+    GHashTable  *seek_indexes;    // yol -> GArray (SeekIndexEntry), son kullanılanlar
+
+    /* Klasör taraması */
+    GHashTable  *library_index; // Diskteki tarama indeksi: yol -> ScanEntry (ilk taramada yüklenir)
+    LibraryScan *library_scan;  // Süren tarama (yoksa NULL)
+
+    /* Headless mod */
+    GMainLoop      *main_loop;       // GTK yerine çalışan ana döngü
+    GSocketService *control_service; // Unix soket kontrol arayüzü
+    gchar          *control_path;    // Soket dosyasının yolu
 } PlayerData;
 
 /* -- İleri deklarasyonlar -- */
-static gboolean update_slider(PlayerData *data);
+static void update_slider(PlayerData *data);
+static void position_updates_start(PlayerData *data);
+static void position_updates_stop(PlayerData *data);
 static void refresh_playlist(PlayerData *data);
+static void prepare_gapless_next(PlayerData *data);
+static void highlight_current_row(PlayerData *data);
 static void update_labels_and_buttons(PlayerData *data);
+static void update_play_button(PlayerData *data);
+static void waveform_request(PlayerData *data);
 static void play_media(PlayerData *data);
 static void stop_media(PlayerData *data);
-static void seek_to_position(GtkRange *range, PlayerData *data);
+static void seek_to_position(PlayerData *data, gdouble seconds, GstSeekFlags flags);
 static void next_media(PlayerData *data);
+static void player_advance(PlayerData *data, gboolean automatic);
+static void play_queue_restart(PlayerData *data, int index);
+static gboolean player_load(PlayerData *data, int index);
+static void prefetch_account(PlayerData *data, int index);
+static void seek_index_on_element_added(GstBin *bin, GstBin *sub_bin, GstElement *element,
+                                        gpointer user_data);
+static gdouble player_track_gain(PlayerData *data, int index);
+static void equalizer_attach(PlayerData *data, GstElement *element);
+static GstElement *equalizer_caps_filter(void);
 static void previous_media(PlayerData *data);
 static void file_chosen(GtkWidget *widget, gpointer user_data);
 static void choose_file(GtkWidget *button, gpointer user_data);
+static void choose_folder(GtkWidget *button, gpointer user_data);
+static void player_build_ui(PlayerData *data, GtkWidget *window);
 
-/* 
- * Müzik sonuna gelindiğinde (EOS) veya herhangi bir mesaj geldiğinde bu callback çalışacak.
- * GStreamer bus'a eklediğimiz watch üzerinden mesajları burada yakalıyoruz.
+/*
+ * Playlist için sanal (virtualized) GtkTreeModel.
+ * Satırlar için widget ya da veri kopyası tutulmaz; GtkTreeView yalnızca
+ * ekranda görünen satırlar için get_value ile PlaylistStore'dan veri ister.
+ * Satır iter'i satır numarasını taşır. Süzgeç yokken satır numarası
+ * playlist indeksine eşittir; arama sırasında filter dizisi satırları
+ * playlist konumlarına eşler.
  */
-static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer user_data) {
-    PlayerData *data = (PlayerData *)user_data;
+struct _PlaylistModel {
+    GObject     parent_instance;
+    PlayerData *data;
+    gint        stamp;    // Liste değiştiğinde artırılır, eski iter'ler geçersiz olur
+    GArray     *filter;   // Görünen konumlar (guint32, artan); NULL: tüm liste
+    gint        shown;    // Görünüme bildirilmiş satır sayısı
+    guint       revision; // Görünümün bildiği PlaylistStore revizyonu
+};
+
+#define PLAYLIST_DELTA_MAX 4096 // Bundan çok satır değişirse model görünüme yeniden bağlanır
+
+#define PLAYLIST_ITER_INDEX(iter) GPOINTER_TO_INT((iter)->user_data)
+
+static void playlist_model_tree_model_init(GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(PlaylistModel, playlist_model, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL, playlist_model_tree_model_init))
+
+static void playlist_model_class_init(PlaylistModelClass *klass) {
+}
+
+static void playlist_model_init(PlaylistModel *model) {
+    model->stamp = (gint)g_random_int();
+}
+
+static gint playlist_model_row_count(PlaylistModel *model) {
+    if (model->filter)
+        return (gint)model->filter->len;
+    return model->data ? playlist_store_count(model->data->playlist) : 0;
+}
+
+/* Satır numarasını playlist konumuna çevirir */
+static inline gint playlist_model_position(PlaylistModel *model, gint row) {
+    return model->filter ? (gint)g_array_index(model->filter, guint32, row) : row;
+}
+
+/* Playlist konumunun satır numarası; süzgeçte görünmüyorsa -1 */
+static gint playlist_model_row_of(PlaylistModel *model, gint position) {
+    if (!model->filter)
+        return position;
+
+    guint low = 0, high = model->filter->len;
+    while (low < high) {
+        guint mid = (low + high) / 2;
+        gint value = (gint)g_array_index(model->filter, guint32, mid);
+        if (value == position)
+            return (gint)mid;
+        if (value < position)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return -1;
+}
+
+/* İndeks geçerliyse iter'i doldurur */
+static gboolean playlist_model_make_iter(PlaylistModel *model, GtkTreeIter *iter, gint index) {
+    if (index < 0 || index >= playlist_model_row_count(model)) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+    iter->stamp = model->stamp;
+    iter->user_data = GINT_TO_POINTER(index);
+    return TRUE;
+}
+
+static GtkTreeModelFlags playlist_model_get_flags(GtkTreeModel *tree_model) {
+    return GTK_TREE_MODEL_LIST_ONLY | GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+static gint playlist_model_get_n_columns(GtkTreeModel *tree_model) {
+    return PLAYLIST_N_COLUMNS;
+}
+
+static GType playlist_model_get_column_type(GtkTreeModel *tree_model, gint index) {
+    return G_TYPE_STRING;
+}
+
+static gboolean playlist_model_get_iter(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path) {
+    if (gtk_tree_path_get_depth(path) != 1) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+    return playlist_model_make_iter(PLAYLIST_MODEL(tree_model), iter, gtk_tree_path_get_indices(path)[0]);
+}
+
+static GtkTreePath *playlist_model_get_path(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    g_return_val_if_fail(iter->stamp == PLAYLIST_MODEL(tree_model)->stamp, NULL);
+    return gtk_tree_path_new_from_indices(PLAYLIST_ITER_INDEX(iter), -1);
+}
+
+static void playlist_model_get_value(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                     gint column, GValue *value) {
+    PlaylistModel *model = PLAYLIST_MODEL(tree_model);
+    gint row = PLAYLIST_ITER_INDEX(iter);
+
+    g_value_init(value, G_TYPE_STRING);
+    g_return_if_fail(iter->stamp == model->stamp && row < playlist_model_row_count(model));
+
+    gint index = playlist_model_position(model, row);
+
+    switch (column) {
+    case PLAYLIST_COL_ICON:
+        g_value_set_static_string(value, "audio-x-generic");
+        break;
+    case PLAYLIST_COL_NAME:
+    {
+        const PlaylistEntry *entry = playlist_store_get(model->data->playlist, index);
+        if (entry->title && entry->artist) {
+            g_value_take_string(value, g_strdup_printf("%s - %s", entry->artist, entry->title));
+        } else {
+            g_value_set_static_string(value, entry->title ? entry->title
+                                                          : entry->path + entry->base_off);
+        }
+        break;
+    }
+    case PLAYLIST_COL_DURATION:
+    {
+        GstClockTime duration = playlist_store_get(model->data->playlist, index)->duration;
+        if (GST_CLOCK_TIME_IS_VALID(duration)) {
+            guint64 seconds = duration / GST_SECOND;
+            g_value_take_string(value, g_strdup_printf("%" G_GUINT64_FORMAT ":%02u",
+                                                       seconds / 60, (guint)(seconds % 60)));
+        }
+        break;
+    }
+    case PLAYLIST_COL_BACKGROUND:
+        g_value_set_static_string(value, index == model->data->current_index
+                                             ? PLAYLIST_SELECTED_ROW_COLOR
+                                             : NULL);
+        break;
+    default:
+        break;
+    }
+}
+
+static gboolean playlist_model_iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    return playlist_model_make_iter(PLAYLIST_MODEL(tree_model), iter, PLAYLIST_ITER_INDEX(iter) + 1);
+}
+
+static gboolean playlist_model_iter_previous(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    return playlist_model_make_iter(PLAYLIST_MODEL(tree_model), iter, PLAYLIST_ITER_INDEX(iter) - 1);
+}
+
+static gboolean playlist_model_iter_children(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                             GtkTreeIter *parent) {
+    if (parent) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+    return playlist_model_make_iter(PLAYLIST_MODEL(tree_model), iter, 0);
+}
+
+static gboolean playlist_model_iter_has_child(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    return FALSE;
+}
+
+static gint playlist_model_iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter) {
+    return iter ? 0 : playlist_model_row_count(PLAYLIST_MODEL(tree_model));
+}
+
+static gboolean playlist_model_iter_nth_child(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                              GtkTreeIter *parent, gint n) {
+    if (parent) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+    return playlist_model_make_iter(PLAYLIST_MODEL(tree_model), iter, n);
+}
+
+static gboolean playlist_model_iter_parent(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                                           GtkTreeIter *child) {
+    iter->stamp = 0;
+    return FALSE;
+}
+
+static void playlist_model_tree_model_init(GtkTreeModelIface *iface) {
+    iface->get_flags       = playlist_model_get_flags;
+    iface->get_n_columns   = playlist_model_get_n_columns;
+    iface->get_column_type = playlist_model_get_column_type;
+    iface->get_iter        = playlist_model_get_iter;
+    iface->get_path        = playlist_model_get_path;
+    iface->get_value       = playlist_model_get_value;
+    iface->iter_next       = playlist_model_iter_next;
+    iface->iter_previous   = playlist_model_iter_previous;
+    iface->iter_children   = playlist_model_iter_children;
+    iface->iter_has_child  = playlist_model_iter_has_child;
+    iface->iter_n_children = playlist_model_iter_n_children;
+    iface->iter_nth_child  = playlist_model_iter_nth_child;
+    iface->iter_parent     = playlist_model_iter_parent;
+}
+
+/* Listenin sonuna eklenen satırı görünüme bildirir (süzgeç açıkken refresh_playlist bildirir) */
+static void playlist_model_row_inserted(PlaylistModel *model, gint index) {
+    GtkTreeIter iter;
+    if (model->filter || !playlist_model_make_iter(model, &iter, index))
+        return;
+
+    GtkTreePath *path = gtk_tree_path_new_from_indices(index, -1);
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+    model->shown++;
+}
+
+/*
+ * Görünümün bildiği satırları (old_filter, old_rows) modelin yeni
+ * süzgecine taşır: kaybolan satırlar sondan başa row-deleted, yeni
+ * satırlar baştan sona row-inserted ile bildirilir. Konumlar arada
+ * kaymamış olmalıdır. Fark PLAYLIST_DELTA_MAX'tan büyükse hiçbir şey
+ * bildirmeden FALSE döner.
+ */
+static gboolean playlist_model_apply_delta(PlaylistModel *model, const GArray *old_filter, gint old_rows) {
+    GArray *deleted = g_array_new(FALSE, FALSE, sizeof(gint));
+    GArray *inserted = g_array_new(FALSE, FALSE, sizeof(gint));
+    gint new_rows = playlist_model_row_count(model);
+    gint i = 0, j = 0;
+
+    // İki artan konum listesinin birleştirilmesi
+    while ((i < old_rows || j < new_rows) && deleted->len + inserted->len <= PLAYLIST_DELTA_MAX) {
+        gint old_position = i < old_rows ? (old_filter ? (gint)g_array_index(old_filter, guint32, i) : i)
+                                         : G_MAXINT;
+        gint new_position = j < new_rows ? playlist_model_position(model, j) : G_MAXINT;
+
+        if (old_position == new_position) {
+            i++;
+            j++;
+        } else if (old_position < new_position) {
+            g_array_append_val(deleted, i);
+            i++;
+        } else {
+            g_array_append_val(inserted, j);
+            j++;
+        }
+    }
+
+    gboolean applied = deleted->len + inserted->len <= PLAYLIST_DELTA_MAX;
+    if (applied) {
+        GtkTreeIter iter;
+        for (guint k = deleted->len; k-- > 0;) {
+            GtkTreePath *path = gtk_tree_path_new_from_indices(g_array_index(deleted, gint, k), -1);
+            gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+            gtk_tree_path_free(path);
+        }
+        for (guint k = 0; k < inserted->len; k++) {
+            gint row = g_array_index(inserted, gint, k);
+            GtkTreePath *path = gtk_tree_path_new_from_indices(row, -1);
+            playlist_model_make_iter(model, &iter, row);
+            gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+            gtk_tree_path_free(path);
+        }
+        model->shown = new_rows;
+    }
+    g_array_free(deleted, TRUE);
+    g_array_free(inserted, TRUE);
+    return applied;
+}
+
+/* Tek bir satırın yeniden çizilmesini ister (diğer satırlara dokunulmaz) */
+static void playlist_model_row_changed(PlaylistModel *model, gint index) {
+    GtkTreeIter iter;
+    gint row = playlist_model_row_of(model, index);
+    if (!playlist_model_make_iter(model, &iter, row))
+        return;
+
+    GtkTreePath *path = gtk_tree_path_new_from_indices(row, -1);
+    gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+}
+
+/*
+ * ---- İstatistikler ----
+ * Çalma hattının ölçümleri bus mesajlarından ve decoder pad probe'larından
+ * toplanır: durum değişimi ve seek süreleri, tamponlama ve QoS olayları,
+ * decoder thread'lerinin CPU zamanı ve ses sink'inin gecikmesi. Her saniye
+ * bir örnek alınır; panel açıksa güncellenir, kayıt açıksa dosyaya
+ * JSON ya da CSV satırı olarak eklenir. Daha ayrıntılı iz için
+ * GStreamer'ın kendi tracer'ları (GST_TRACERS=latency;stats) da kullanılabilir.
+ */
+
+#define STATS_CSV_HEADER "time,state_changes,state_last_ms,state_max_ms,seeks,seek_last_ms,seek_max_ms," \
+                         "buffering_events,buffering_percent,underruns,qos_events,late_buffers," \
+                         "dropped_buffers,max_jitter_ms,cpu_percent,decoder_cpu_percent,sink_latency_ms\n"
+
+static gint64 process_cpu_time(void);
+
+static gint64 thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (gint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+ * Decoder çıkışındaki buffer probe'u (streaming thread). Aynı thread'de iki
+ * buffer arasında geçen CPU zamanı o thread'in okuma, ayrıştırma ve çözme
+ * işidir.
+ */
+static GstPadProbeReturn stats_decoder_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    PlayerStats *stats = user_data;
+    GThread *self = g_thread_self();
+    gint64 now = thread_cpu_ns();
+
+    g_mutex_lock(&stats->lock);
+    gpointer last;
+    if (g_hash_table_lookup_extended(stats->decoder_threads, self, NULL, &last)) {
+        // Biten bir thread'in adresi yeniden kullanılmış olabilir: saat geri gittiyse sayılmaz
+        if (now > *(gint64 *)last)
+            stats->decoder_cpu_ns += now - *(gint64 *)last;
+        *(gint64 *)last = now;
+    } else {
+        // Her parça yeni thread açar; eski kayıtlar ara sıra topluca bırakılır
+        if (g_hash_table_size(stats->decoder_threads) >= 64)
+            g_hash_table_remove_all(stats->decoder_threads);
+        gint64 *value = g_new(gint64, 1);
+        *value = now;
+        g_hash_table_insert(stats->decoder_threads, self, value);
+    }
+    g_mutex_unlock(&stats->lock);
+    return GST_PAD_PROBE_OK;
+}
+
+/* Pipeline'a (alt bin'ler dahil) eklenen ses decoder'larının çıkışına probe koyar */
+static void stats_on_element_added(GstBin *bin, GstBin *sub_bin, GstElement *element, gpointer user_data) {
+    GstElementFactory *factory = gst_element_get_factory(element);
+    const gchar *klass = factory ? gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS) : NULL;
+
+    if (!klass || !strstr(klass, "Decoder") || !strstr(klass, "Audio"))
+        return;
+
+    GstPad *pad = gst_element_get_static_pad(element, "src");
+    if (pad) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, stats_decoder_probe, user_data, NULL);
+        gst_object_unref(pad);
+    }
+}
+
+static void stats_init(PlayerStats *stats) {
+    g_mutex_init(&stats->lock);
+    stats->decoder_threads = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    stats->buffering_percent = 100;
+    stats->sink_latency_ms = -1;
+    stats->sample_wall = g_get_monotonic_time();
+    stats->sample_cpu = process_cpu_time();
+}
+
+static void stats_record_ms(gint64 since, gdouble *last, gdouble *max) {
+    *last = (g_get_monotonic_time() - since) / 1000.0;
+    *max = MAX(*max, *last);
+}
+
+/* Pipeline'ı hedef duruma geçirir; eşzamansız geçişin süresi bus'ta ölçülür (herhangi bir thread) */
+static GstStateChangeReturn stats_set_state(PlayerStats *stats, GstElement *pipeline, GstState state) {
+    gint64 start = g_get_monotonic_time();
+
+    g_mutex_lock(&stats->lock);
+    stats->state_requested = start;
+    stats->state_target = state;
+    g_mutex_unlock(&stats->lock);
+
+    GstStateChangeReturn ret = gst_element_set_state(pipeline, state);
+    if (ret != GST_STATE_CHANGE_ASYNC) {
+        // Eşzamanlı geçiş: mesajı beklemeye gerek yok
+        g_mutex_lock(&stats->lock);
+        if (stats->state_requested == start) {
+            if (ret == GST_STATE_CHANGE_SUCCESS) {
+                stats_record_ms(start, &stats->state_last_ms, &stats->state_max_ms);
+                stats->state_changes++;
+            }
+            stats->state_requested = 0;
+        }
+        g_mutex_unlock(&stats->lock);
+    }
+    return ret;
+}
+
+/* Etkin pipeline'ın bus mesajlarını ölçümlere işler (ana thread) */
+static void stats_handle_message(PlayerData *data, GstMessage *msg) {
+    PlayerStats *stats = &data->stats;
+
+    switch (GST_MESSAGE_TYPE(msg)) {
+    case GST_MESSAGE_STATE_CHANGED:
+    {
+        GstState new_state, pending;
+        if (GST_MESSAGE_SRC(msg) != GST_OBJECT(data->pipeline))
+            break;
+        gst_message_parse_state_changed(msg, NULL, &new_state, &pending);
+        g_mutex_lock(&stats->lock);
+        if (stats->state_requested && new_state == stats->state_target && pending == GST_STATE_VOID_PENDING) {
+            stats_record_ms(stats->state_requested, &stats->state_last_ms, &stats->state_max_ms);
+            stats->state_changes++;
+            stats->state_requested = 0;
+        }
+        g_mutex_unlock(&stats->lock);
+        break;
+    }
+    case GST_MESSAGE_ASYNC_DONE:
+        // Flush'lı seek'ten sonra pipeline yeniden preroll oldu (parça/durum değişimlerinin
+        // ASYNC_DONE'ları seek'in sıra numarasını taşımaz)
+        if (stats->seek_requested && gst_message_get_seqnum(msg) == stats->seek_seqnum) {
+            stats_record_ms(stats->seek_requested, &stats->seek_last_ms, &stats->seek_max_ms);
+            stats->seeks++;
+            stats->seek_requested = 0;
+        }
+        break;
+    case GST_MESSAGE_BUFFERING:
+    {
+        gint percent;
+        gst_message_parse_buffering(msg, &percent);
+        if (percent < 100 && stats->buffering_percent >= 100 && data->is_playing)
+            stats->underruns++;
+        stats->buffering_events++;
+        stats->buffering_percent = percent;
+        break;
+    }
+    case GST_MESSAGE_QOS:
+    {
+        gint64 jitter;
+        guint64 processed, dropped;
+        GstFormat format;
+
+        gst_message_parse_qos_values(msg, &jitter, NULL, NULL);
+        gst_message_parse_qos_stats(msg, &format, &processed, &dropped);
+        stats->qos_events++;
+        if (jitter > 0) {
+            stats->late_buffers++;
+            stats->max_jitter_ms = MAX(stats->max_jitter_ms, (gdouble)jitter / GST_MSECOND);
+        }
+        if (format == GST_FORMAT_BUFFERS && dropped != (guint64)-1)
+            stats->dropped_buffers = MAX(stats->dropped_buffers, dropped);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/*
+ * Ses sink'inin ölçülen çıkış gecikmesi (ms); bulunamazsa -1. Sink'e son
+ * verilen buffer'ın bittiği an ile sink'in o an duyulan konumu arasındaki
+ * fark, ses aygıtının tamponunda bekleyen sesin süresidir. Dosya çalarken
+ * pipeline canlı olmadığı için latency sorgusu 0 döner; bu yüzden sink'in
+ * kendi gecikmesi kullanılır.
+ */
+static gdouble stats_sink_latency(GstElement *pipeline) {
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    gdouble latency = -1;
+
+    while (latency < 0 && gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+        GstElement *element = g_value_get_object(&item);
+        GstSample *sample = NULL;
+        gint64 position;
+
+        if (GST_OBJECT_FLAG_IS_SET(element, GST_ELEMENT_FLAG_SINK) &&
+            g_object_class_find_property(G_OBJECT_GET_CLASS(element), "last-sample")) {
+            g_object_get(element, "last-sample", &sample, NULL);
+        }
+        if (sample && gst_element_query_position(element, GST_FORMAT_TIME, &position)) {
+            GstBuffer *buffer = gst_sample_get_buffer(sample);
+            const GstSegment *segment = gst_sample_get_segment(sample);
+            GstClockTime end = GST_CLOCK_TIME_NONE;
+
+            if (buffer && segment && GST_BUFFER_PTS_IS_VALID(buffer)) {
+                end = GST_BUFFER_PTS(buffer);
+                if (GST_BUFFER_DURATION_IS_VALID(buffer))
+                    end += GST_BUFFER_DURATION(buffer);
+                end = gst_segment_to_stream_time(segment, GST_FORMAT_TIME, end);
+            }
+            if (GST_CLOCK_TIME_IS_VALID(end))
+                latency = end > (GstClockTime)position ? (gdouble)(end - position) / GST_MSECOND : 0.0;
+        }
+        if (sample)
+            gst_sample_unref(sample);
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return latency;
+}
+
+/* Ölçümlerin anlık görüntüsü, tek satır JSON */
+static gchar *stats_to_json(PlayerData *data) {
+    PlayerStats *s = &data->stats;
+    g_mutex_lock(&s->lock);
+    gchar *json = g_strdup_printf("{\"time\": %.3f, \"state_changes\": %u, \"state_last_ms\": %.3f, \"state_max_ms\": %.3f, "
+                           "\"seeks\": %u, \"seek_last_ms\": %.3f, \"seek_max_ms\": %.3f, "
+                           "\"buffering_events\": %u, \"buffering_percent\": %d, \"underruns\": %u, "
+                           "\"qos_events\": %u, \"late_buffers\": %u, \"dropped_buffers\": %" G_GUINT64_FORMAT ", "
+                           "\"max_jitter_ms\": %.3f, \"cpu_percent\": %.1f, \"decoder_cpu_percent\": %.1f, "
+                           "\"sink_latency_ms\": %.1f}",
+                           g_get_real_time() / (gdouble)G_USEC_PER_SEC, s->state_changes, s->state_last_ms,
+                           s->state_max_ms, s->seeks, s->seek_last_ms, s->seek_max_ms,
+                           s->buffering_events, s->buffering_percent, s->underruns,
+                           s->qos_events, s->late_buffers, s->dropped_buffers, s->max_jitter_ms,
+                           s->cpu_percent, s->decoder_cpu_percent, s->sink_latency_ms);
+    g_mutex_unlock(&s->lock);
+    return json;
+}
+
+static void stats_write_csv(PlayerData *data) {
+    PlayerStats *s = &data->stats;
+    g_mutex_lock(&s->lock);
+    fprintf(s->log, "%.3f,%u,%.3f,%.3f,%u,%.3f,%.3f,%u,%d,%u,%u,%u,%" G_GUINT64_FORMAT ",%.3f,%.1f,%.1f,%.1f\n",
+            g_get_real_time() / (gdouble)G_USEC_PER_SEC, s->state_changes, s->state_last_ms,
+            s->state_max_ms, s->seeks, s->seek_last_ms, s->seek_max_ms,
+            s->buffering_events, s->buffering_percent, s->underruns,
+            s->qos_events, s->late_buffers, s->dropped_buffers, s->max_jitter_ms,
+            s->cpu_percent, s->decoder_cpu_percent, s->sink_latency_ms);
+    g_mutex_unlock(&s->lock);
+}
+
+/* Paneldeki metin */
+static void stats_update_panel(PlayerData *data) {
+    PlayerStats *s = &data->stats;
+    g_mutex_lock(&s->lock);
+    gchar *text = g_strdup_printf(
+        "Durum değişimi: %u (son %.1f ms, en çok %.1f ms)\n"
+        "Seek → çalma: %u (son %.1f ms, en çok %.1f ms)\n"
+        "Tamponlama: %u olay, %%%d, %u kesinti\n"
+        "QoS: %u olay, %u geç buffer, %" G_GUINT64_FORMAT " atılan, en çok %.1f ms jitter\n"
+        "CPU: işlem %%%.1f, decoder %%%.1f\n"
+        "Sink gecikmesi: %s",
+        s->state_changes, s->state_last_ms, s->state_max_ms,
+        s->seeks, s->seek_last_ms, s->seek_max_ms,
+        s->buffering_events, s->buffering_percent, s->underruns,
+        s->qos_events, s->late_buffers, s->dropped_buffers, s->max_jitter_ms,
+        s->cpu_percent, s->decoder_cpu_percent,
+        s->sink_latency_ms >= 0 ? "" : "bilinmiyor");
+    g_mutex_unlock(&s->lock);
+    if (s->sink_latency_ms >= 0) {
+        gchar *full = g_strdup_printf("%s%.1f ms", text, s->sink_latency_ms);
+        g_free(text);
+        text = full;
+    }
+    gtk_label_set_text(GTK_LABEL(data->stats_label), text);
+    g_free(text);
+}
+
+/* Saniyede bir: CPU ve gecikme örneği alır, paneli ve kaydı günceller */
+static gboolean stats_tick(gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    PlayerStats *s = &data->stats;
+    gboolean panel = data->stats_expander &&
+                     gtk_expander_get_expanded(GTK_EXPANDER(data->stats_expander));
+
+    if (!panel && !s->log)
+        return G_SOURCE_CONTINUE;
+
+    gint64 wall = g_get_monotonic_time();
+    gint64 cpu = process_cpu_time();
+    g_mutex_lock(&s->lock);
+    gint64 decoder = s->decoder_cpu_ns;
+    g_mutex_unlock(&s->lock);
+
+    if (wall > s->sample_wall) {
+        s->cpu_percent = 100.0 * (cpu - s->sample_cpu) / (wall - s->sample_wall);
+        s->decoder_cpu_percent = 100.0 * (decoder - s->sample_decoder) / 1000.0 / (wall - s->sample_wall);
+    }
+    s->sample_wall = wall;
+    s->sample_cpu = cpu;
+    s->sample_decoder = decoder;
+    s->sink_latency_ms = stats_sink_latency(data->pipeline);
+
+    if (panel)
+        stats_update_panel(data);
+
+    if (s->log) {
+        if (s->log_csv) {
+            stats_write_csv(data);
+        } else {
+            gchar *line = stats_to_json(data);
+            fprintf(s->log, "%s\n", line);
+            g_free(line);
+        }
+        fflush(s->log);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+/* Periyodik kaydı başlatır; ".csv" uzantılı dosyalar CSV, diğerleri JSON satırları olur */
+static gboolean stats_log_open(PlayerData *data, const gchar *path) {
+    FILE *log = g_fopen(path, "a");
+    if (!log) {
+        g_printerr("Hata: İstatistik kaydı açılamadı: %s\n", path);
+        return FALSE;
+    }
+    if (data->stats.log)
+        fclose(data->stats.log);
+
+    data->stats.log = log;
+    data->stats.log_csv = g_str_has_suffix(path, ".csv");
+    if (data->stats.log_csv && ftell(log) == 0)
+        fputs(STATS_CSV_HEADER, log);
+    return TRUE;
+}
+
+static void stats_log_close(PlayerData *data) {
+    if (data->stats.log) {
+        fclose(data->stats.log);
+        data->stats.log = NULL;
+    }
+}
+
+/* Paneldeki "Kaydet" düğmesi: kayıt önbellek klasöründe CSV olarak tutulur */
+static void on_stats_log_toggled(GtkToggleButton *toggle, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    if (!gtk_toggle_button_get_active(toggle)) {
+        stats_log_close(data);
+        return;
+    }
+
+    gchar *dir = g_build_filename(g_get_user_cache_dir(), "mp3_player", NULL);
+    GDateTime *now = g_date_time_new_now_local();
+    gchar *name = g_date_time_format(now, "stats-%Y%m%d-%H%M%S.csv");
+    gchar *path = g_build_filename(dir, name, NULL);
+
+    g_mkdir_with_parents(dir, 0755);
+    if (stats_log_open(data, path)) {
+        gtk_widget_set_tooltip_text(GTK_WIDGET(toggle), path);
+    } else {
+        gtk_toggle_button_set_active(toggle, FALSE);
+    }
+    g_free(path);
+    g_free(name);
+    g_date_time_unref(now);
+    g_free(dir);
+}
+
+/*
+ * ---- Çalma kontrolü ----
+ * playbin'in durum değişimleri (özellikle NULL'a iniş ve ses aygıtının
+ * açılışı) onlarca ms sürebilir. Ana thread bunları beklemez: indeks,
+ * etiketler ve butonlar hemen güncellenir, pipeline işleri komut olarak
+ * kontrol thread'ine gönderilir. Thread o ana kadar biriken komutları
+ * birleştirir: arka arkaya on "sonraki" basışı tek bir yükleme olur.
+ * Geçiş modunda motor ana thread'e bağlı olduğundan komutlar hemen
+ * uygulanır.
+ *
+ * Her yükleme/durdurma bir nesil numarası alır. Pipeline NULL'a indiğinde
+ * uygulanan nesil güncellenir ve bus'a gelen her mesaj, gönderildiği
+ * andaki nesille işaretlenir. Böylece eski parçanın, yeni parça seçildikten
+ * sonra işlenen EOS/ERROR/ASYNC_DONE mesajları atılır; eskiden eşzamanlı
+ * NULL geçişi bus'ı boşaltıyordu.
+ */
+
+/* Durum değişiminin sonucu; ana thread'de teslim alınır */
+typedef struct {
+    PlayerData          *data;
+    GstState             state;
+    GstStateChangeReturn result;
+} ControlResult;
+
+static gboolean control_result_done(gpointer user_data) {
+    ControlResult *result = user_data;
+    PlayerData *data = result->data;
+
+    if (result->result == GST_STATE_CHANGE_FAILURE && result->state > GST_STATE_NULL) {
+        g_printerr("Hata: Pipeline %s durumuna geçemedi.\n", gst_element_state_get_name(result->state));
+        data->is_playing = FALSE;
+        position_updates_stop(data);
+        update_play_button(data);
+    }
+    g_free(result);
+    return G_SOURCE_REMOVE;
+}
+
+static void control_set_state(PlayerData *data, GstState state) {
+    GstStateChangeReturn ret = stats_set_state(&data->stats, data->playbin, state);
+
+    if (ret == GST_STATE_CHANGE_FAILURE) {
+        ControlResult *result = g_new0(ControlResult, 1);
+        result->data = data;
+        result->state = state;
+        result->result = ret;
+        g_idle_add(control_result_done, result);
+    }
+}
+
+static void control_command_free(ControlCommand *command) {
+    g_free(command->uri);
+    g_free(command);
+}
+
+/*
+ * Biriken komutları tek geçişe indirger: en son yüklenen URI, son hedef
+ * durum ve arada bir durdurma/yükleme varsa NULL'a iniş.
+ */
+static guint control_execute_batch(PlayerData *data, ControlCommand *list) {
+    ControlCommand *fifo = NULL, *load = NULL;
+    gboolean reset = FALSE;
+    guint generation = 0;
+    GstState target = GST_STATE_VOID_PENDING;
+    guint count = 0;
+
+    // Yığın en yeniden eskiye; sırayı çevir
+    while (list) {
+        ControlCommand *next = list->next;
+        list->next = fifo;
+        fifo = list;
+        list = next;
+    }
+
+    for (ControlCommand *command = fifo; command; command = command->next) {
+        switch (command->type) {
+        case CONTROL_LOAD:
+            load = command;
+            /* fall through */
+        case CONTROL_STOP:
+            reset = TRUE;
+            generation = command->generation;
+            target = GST_STATE_NULL;
+            break;
+        case CONTROL_PLAY:
+            target = GST_STATE_PLAYING;
+            break;
+        case CONTROL_PAUSE:
+            target = GST_STATE_PAUSED;
+            break;
+        }
+        count++;
+    }
+
+    if (reset) {
+        control_set_state(data, GST_STATE_NULL);
+        // Geçiş ölçümü eski akışla birlikte biter; sıfırlamayı probe yapar
+        g_atomic_int_set(&data->gap_probe.reset_pending, TRUE);
+        // Bundan sonra gelen mesajlar yeni nesle aittir
+        g_atomic_int_set(&data->control.applied, (gint)generation);
+    }
+    if (load) {
+        g_object_set(data->playbin, "uri", load->uri, NULL);
+        if (data->normalize_volume)
+            g_object_set(data->normalize_volume, "volume", load->gain, NULL);
+    }
+    if (target == GST_STATE_PLAYING || target == GST_STATE_PAUSED)
+        control_set_state(data, target);
+
+    while (fifo) {
+        ControlCommand *next = fifo->next;
+        control_command_free(fifo);
+        fifo = next;
+    }
+    return count;
+}
+
+static gpointer control_thread(gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    PlayerControl *control = &data->control;
+
+    for (;;) {
+        g_mutex_lock(&control->wake_lock);
+        while (!g_atomic_pointer_get(&control->head) && !control->quit)
+            g_cond_wait(&control->wake, &control->wake_lock);
+        gboolean quit = control->quit && !g_atomic_pointer_get(&control->head);
+        g_mutex_unlock(&control->wake_lock);
+        if (quit)
+            break;
+
+        ControlCommand *list = g_atomic_pointer_exchange(&control->head, NULL);
+        guint count = control_execute_batch(data, list);
+
+        g_mutex_lock(&control->wake_lock);
+        g_atomic_int_add(&control->done, count);
+        control->executed++;
+        g_cond_broadcast(&control->idle);
+        g_mutex_unlock(&control->wake_lock);
+    }
+    return NULL;
+}
+
+static void player_control_init(PlayerData *data) {
+    g_mutex_init(&data->control.wake_lock);
+    g_cond_init(&data->control.wake);
+    g_cond_init(&data->control.idle);
+    data->control.thread = g_thread_new("player-control", control_thread, data);
+}
+
+/* Komutu kuyruğa ekler (beklemez) */
+static void player_control_push(PlayerData *data, ControlType type, const gchar *uri, gdouble gain) {
+    PlayerControl *control = &data->control;
+    ControlCommand *command = g_new0(ControlCommand, 1);
+
+    command->type = type;
+    command->uri = g_strdup(uri);
+    command->gain = gain;
+    if (type == CONTROL_LOAD || type == CONTROL_STOP)
+        command->generation = ++control->generation;
+    g_atomic_int_inc(&control->pushed);
+    do {
+        command->next = g_atomic_pointer_get(&control->head);
+    } while (!g_atomic_pointer_compare_and_exchange(&control->head, command->next, command));
+
+    g_mutex_lock(&control->wake_lock);
+    g_cond_signal(&control->wake);
+    g_mutex_unlock(&control->wake_lock);
+}
+
+/* Kuyrukta henüz uygulanmamış komut var mı (herhangi bir thread) */
+static gboolean player_control_pending(PlayerData *data) {
+    return g_atomic_int_get(&data->control.done) != g_atomic_int_get(&data->control.pushed);
+}
+
+/* Son istenen yükleme/durdurma pipeline'a henüz uygulanmadı mı (ana thread) */
+static gboolean player_control_stale(PlayerData *data) {
+    return data->control.generation != (guint)g_atomic_int_get(&data->control.applied);
+}
+
+static GQuark player_generation_quark(void) {
+    static GQuark quark;
+    if (!quark)
+        quark = g_quark_from_static_string("mp3-player-generation");
+    return quark;
+}
+
+/* Bus sync handler'ı (mesajı gönderen thread): mesajı o anki nesille işaretler */
+static GstBusSyncReply player_bus_stamp(GstBus *bus, GstMessage *msg, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    gst_mini_object_set_qdata(GST_MINI_OBJECT(msg), player_generation_quark(),
+                              GUINT_TO_POINTER((guint)g_atomic_int_get(&data->control.applied)), NULL);
+    return GST_BUS_PASS;
+}
+
+/* Mesaj, yerine başka parça seçilmiş eski bir akıştan mı geliyor */
+static gboolean player_message_stale(PlayerData *data, GstMessage *msg) {
+    switch (GST_MESSAGE_TYPE(msg)) {
+    case GST_MESSAGE_EOS:
+    case GST_MESSAGE_ERROR:
+    case GST_MESSAGE_ASYNC_DONE:
+        return GPOINTER_TO_UINT(gst_mini_object_get_qdata(GST_MINI_OBJECT(msg), player_generation_quark()))
+               != data->control.generation;
+    default:
+        return FALSE;
+    }
+}
+
+/* Kuyruktaki tüm komutlar uygulanana kadar bekler (mod değişimi, kapanış) */
+static void player_control_sync(PlayerData *data) {
+    PlayerControl *control = &data->control;
+
+    g_mutex_lock(&control->wake_lock);
+    while (player_control_pending(data))
+        g_cond_wait(&control->idle, &control->wake_lock);
+    g_mutex_unlock(&control->wake_lock);
+}
+
+/*
+ * Kuyruktaki komutlar uygulandıktan sonra kontrol thread'ini durdurur ve
+ * bekler. Pipeline bundan sonra güvenle bırakılabilir.
+ */
+static void player_control_shutdown(PlayerData *data) {
+    PlayerControl *control = &data->control;
+
+    if (!control->thread)
+        return;
+    g_mutex_lock(&control->wake_lock);
+    control->quit = TRUE;
+    g_cond_broadcast(&control->wake);
+    g_mutex_unlock(&control->wake_lock);
+    g_thread_join(control->thread);
+    control->thread = NULL;
+}
+
+/* Oturumdan gelen parça hazır (preroll bitti): kaydedilen konuma gider */
+static void session_seek_restored(PlayerData *data) {
+    if (!GST_CLOCK_TIME_IS_VALID(data->restore_position))
+        return;
+
+    GstClockTime position = data->restore_position;
+    data->restore_position = GST_CLOCK_TIME_NONE;
+    seek_to_position(data, (gdouble)position / GST_SECOND,
+                     GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE);
+    if (data->slider && !data->is_playing)
+        update_slider(data);
+}
+
+/* 
+ * Müzik sonuna gelindiğinde (EOS) veya herhangi bir mesaj geldiğinde bu callback çalışacak.
+ * GStreamer bus'a eklediğimiz watch üzerinden mesajları burada yakalıyoruz.
+ */
+static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    stats_handle_message(data, msg);
+    if (player_message_stale(data, msg))
+        return TRUE;
+
+    switch (GST_MESSAGE_TYPE(msg)) {
+    case GST_MESSAGE_EOS:
+        // Müzik bittiğinde otomatik olarak sonraki şarkıya geç
+        player_advance(data, TRUE);
+        break;
+    case GST_MESSAGE_STREAM_START:
+    {
+        // about-to-finish ile kuyruğa alınan parça çalmaya başladı
+        int queued;
+        g_mutex_lock(&data->gapless_lock);
+        queued = data->queued_index;
+        data->queued_index = -1;
+        g_mutex_unlock(&data->gapless_lock);
+
+        if (queued >= 0 && queued < playlist_store_count(data->playlist)) {
+            prefetch_account(data, queued);
+            if (!data->queue.repeat_one)
+                play_queue_restart(data, queued);
+            data->current_index = queued;
+            data->duration = GST_CLOCK_TIME_NONE;
+            update_labels_and_buttons(data);
+        }
+        break;
+    }
+    case GST_MESSAGE_ASYNC_DONE:
+        session_seek_restored(data);
+        break;
+    case GST_MESSAGE_DURATION_CHANGED:
+        // Süre bir sonraki konum güncellemesinde bir kez yeniden sorgulanır
+        data->duration = GST_CLOCK_TIME_NONE;
+        break;
+    case GST_MESSAGE_APPLICATION:
+    {
+        // Sink probe'unun ölçtüğü geçiş sessizliği
+        const GstStructure *s = gst_message_get_structure(msg);
+        guint64 gap = 0, buffer_duration = 0;
+
+        if (gst_structure_has_name(s, "track-gap") &&
+            gst_structure_get_uint64(s, "gap", &gap) &&
+            gst_structure_get_uint64(s, "buffer-duration", &buffer_duration)) {
+            data->last_gap = gap;
+            data->max_gap = MAX(data->max_gap, gap);
+            g_debug("Parça geçişi: %.3f ms sessizlik (buffer: %.3f ms)%s",
+                    (gdouble)gap / GST_MSECOND, (gdouble)buffer_duration / GST_MSECOND,
+                    gap > buffer_duration ? " - UYARI: bir buffer'dan uzun" : "");
+        }
+        break;
+    }
+    case GST_MESSAGE_ERROR:
+    {
+        GError *err;
+        gchar *debug_info;
+        gst_message_parse_error(msg, &err, &debug_info);
+        g_printerr("Hata: %s\n", err->message);
+        g_error_free(err);
+        g_free(debug_info);
+        stop_media(data);
+        break;
+    }
+    default:
+        break;
+    }
+    return TRUE; 
+}
+
+/*
+ * playbin mevcut parçanın sonuna yaklaştığında streaming thread'inden çağrılır.
+ * Hazırlanmış bir sonraki URI varsa onu verir; playbin decoder ve sink'i
+ * kapatmadan yeni parçaya geçer.
+ */
+static void on_about_to_finish(GstElement *playbin, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    g_mutex_lock(&data->gapless_lock);
+    // Kontrol thread'inde bekleyen durdurma/yükleme varsa parça zaten değişiyor
+    if (data->gapless_enabled && data->gapless_uri && !player_control_pending(data)) {
+        g_object_set(playbin, "uri", data->gapless_uri, NULL);
+        data->queued_index = data->gapless_index;
+        data->queued_gain = data->gapless_gain;
+        g_free(data->gapless_uri);
+        data->gapless_uri = NULL;
+    }
+    g_mutex_unlock(&data->gapless_lock);
+}
+
+/*
+ * Sink'e giden buffer'ları izler. STREAM_START'tan sonraki ilk buffer ile
+ * önceki parçanın son buffer'ı arasındaki running-time farkını ölçer ve
+ * sonucu bus üzerinden ana thread'e gönderir.
+ */
+static GstPadProbeReturn gap_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    GapProbe *probe = &data->gap_probe;
+
+    if (g_atomic_int_compare_and_exchange(&probe->reset_pending, TRUE, FALSE)) {
+        probe->last_end = GST_CLOCK_TIME_NONE;
+        probe->track_changed = FALSE;
+    }
+
+    if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+        GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+
+        switch (GST_EVENT_TYPE(event)) {
+        case GST_EVENT_STREAM_START:
+            probe->track_changed = GST_CLOCK_TIME_IS_VALID(probe->last_end);
+            break;
+        case GST_EVENT_SEGMENT:
+            gst_event_copy_segment(event, &probe->segment);
+            break;
+        case GST_EVENT_FLUSH_STOP:
+            // Seek sonrası ölçüm anlamsız
+            probe->last_end = GST_CLOCK_TIME_NONE;
+            probe->track_changed = FALSE;
+            break;
+        default:
+            break;
+        }
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (!GST_BUFFER_PTS_IS_VALID(buffer) || probe->segment.format != GST_FORMAT_TIME)
+        return GST_PAD_PROBE_OK;
+
+    GstClockTime start = gst_segment_to_running_time(&probe->segment, GST_FORMAT_TIME,
+                                                     GST_BUFFER_PTS(buffer));
+    GstClockTime duration = GST_BUFFER_DURATION(buffer);
+
+    if (probe->track_changed && GST_CLOCK_TIME_IS_VALID(start)) {
+        guint64 gap = start > probe->last_end ? start - probe->last_end : 0;
+        GstStructure *s = gst_structure_new("track-gap",
+                                            "gap", G_TYPE_UINT64, gap,
+                                            "buffer-duration", G_TYPE_UINT64,
+                                            GST_CLOCK_TIME_IS_VALID(duration) ? duration : 0,
+                                            NULL);
+        gst_element_post_message(data->playbin,
+                                 gst_message_new_application(GST_OBJECT(data->playbin), s));
+        probe->track_changed = FALSE;
+    }
+
+    if (GST_CLOCK_TIME_IS_VALID(start) && GST_CLOCK_TIME_IS_VALID(duration)) {
+        probe->last_end = start + duration;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+/*
+ * ---- Çalma kuyruğu ----
+ * Sonraki/önceki parça playlist sırasından ayrı olarak burada seçilir:
+ *
+ *   1. Kullanıcının kuyruğu ("sıradaki olarak çal" başa, "sıraya ekle"
+ *      sona eklenir) her zaman önce çalar.
+ *   2. Karışık çalmada sıra, tembel (incremental) Fisher-Yates ile her
+ *      adımda bir parça çekilerek oluşur. Permütasyon dizisi tutulmaz;
+ *      yalnızca yeri değişen konumlar iki hash tablosunda durur, bu yüzden
+ *      çekiş O(1)'dir ve büyük listeler kopyalanmaz. Çekilenler history'e
+ *      yazılır; önceki/sonraki history'de gezinir. Tur bitince döngü
+ *      açıksa yeni tur başlar, değilse çalma durur.
+ *   3. Karışık değilse playlist sırası izlenir (anchor: kuyruktan çalınan
+ *      parçalar sıradaki yeri değiştirmez).
+ *
+ * Parçayı tekrarla açıkken yalnızca kendiliğinden geçişler (parça bitti,
+ * boşluksuz/geçişli sonraki) aynı parçayı seçer; butonlar yine ilerler.
+ * Kuyruk, çalan parça değiştiğinde (hangi yoldan olursa olsun) bir sonraki
+ * sorguda ona uyar. Sona ekleme dışındaki liste değişikliklerinde
+ * konumlar kaydığı için kuyruk sıfırlanır.
+ */
+
+#define QUEUE_HISTORY_MAX 10000 // Karışık çalmada geri gidilebilecek parça sayısı
+
+/* Permütasyondaki slot'taki konum (değişmemişse slot'un kendisi) */
+static gint play_queue_at(PlayQueue *queue, gint slot) {
+    gpointer value;
+    return g_hash_table_lookup_extended(queue->at_slot, GINT_TO_POINTER(slot), NULL, &value)
+           ? GPOINTER_TO_INT(value) : slot;
+}
+
+static gint play_queue_slot_of(PlayQueue *queue, gint position) {
+    gpointer value;
+    return g_hash_table_lookup_extended(queue->slot_of, GINT_TO_POINTER(position), NULL, &value)
+           ? GPOINTER_TO_INT(value) : position;
+}
+
+static void play_queue_swap(PlayQueue *queue, gint a, gint b) {
+    gint at_a = play_queue_at(queue, a), at_b = play_queue_at(queue, b);
+
+    g_hash_table_insert(queue->at_slot, GINT_TO_POINTER(a), GINT_TO_POINTER(at_b));
+    g_hash_table_insert(queue->slot_of, GINT_TO_POINTER(at_b), GINT_TO_POINTER(a));
+    g_hash_table_insert(queue->at_slot, GINT_TO_POINTER(b), GINT_TO_POINTER(at_a));
+    g_hash_table_insert(queue->slot_of, GINT_TO_POINTER(at_a), GINT_TO_POINTER(b));
+}
+
+/* Konumu bu turda çekilmiş sayar (henüz çekilmediyse çekilenlerin sonuna alır) */
+static void play_queue_mark_drawn(PlayQueue *queue, gint position) {
+    gint slot = play_queue_slot_of(queue, position);
+    if (slot >= queue->drawn) {
+        play_queue_swap(queue, queue->drawn, slot);
+        queue->drawn++;
+    }
+}
+
+/* Karıştırma turunu sıfırlar; history ve kullanıcının kuyruğu korunur */
+static void play_queue_new_round(PlayQueue *queue) {
+    g_hash_table_remove_all(queue->at_slot);
+    g_hash_table_remove_all(queue->slot_of);
+    queue->drawn = 0;
+}
+
+/* Turdan rastgele bir parça çeker; tur bitmiş ve döngü kapalıysa -1 */
+static gint play_queue_draw(PlayerData *data) {
+    PlayQueue *queue = &data->queue;
+    int count = playlist_store_count(data->playlist);
+
+    if (queue->drawn >= count) {
+        if (!data->loop_enabled)
+            return -1;
+        // Yeni tur; çalan parça hemen yeniden gelmesin
+        play_queue_new_round(queue);
+        play_queue_mark_drawn(queue, data->current_index);
+        if (queue->drawn >= count)
+            return data->current_index;
+    }
+
+    gint slot = g_rand_int_range(queue->rand, queue->drawn, count);
+    gint position = play_queue_at(queue, slot);
+    play_queue_swap(queue, queue->drawn, slot);
+    queue->drawn++;
+    return position;
+}
+
+static void play_queue_history_push(PlayQueue *queue, gint position) {
+    g_array_append_val(queue->history, position);
+    if (queue->history->len > 2 * QUEUE_HISTORY_MAX && queue->cursor >= QUEUE_HISTORY_MAX) {
+        g_array_remove_range(queue->history, 0, QUEUE_HISTORY_MAX);
+        queue->cursor -= QUEUE_HISTORY_MAX;
+    }
+}
+
+/* Kuyruğu playlist'e ve çalan parçaya uydurur; her sorgudan önce çağrılır */
+static void play_queue_sync(PlayerData *data) {
+    PlayQueue *queue = &data->queue;
+    int count = playlist_store_count(data->playlist);
+    int current = data->current_index;
+
+    // Konumlar kaydı: eski kuyruk ve tur geçersiz
+    if (queue->revision != data->playlist->revision) {
+        queue->revision = data->playlist->revision;
+        g_queue_clear(&queue->upcoming);
+        g_array_set_size(queue->history, 0);
+        queue->cursor = 0;
+        queue->current = -1;
+        play_queue_new_round(queue);
+    }
+    if (current == queue->current || current < 0 || current >= count)
+        return;
+    queue->current = current;
+
+    gboolean from_queue = !g_queue_is_empty(&queue->upcoming) &&
+                          GPOINTER_TO_INT(g_queue_peek_head(&queue->upcoming)) == current;
+    if (from_queue) {
+        g_queue_pop_head(&queue->upcoming);
+    } else {
+        queue->anchor = current;
+    }
+    if (!queue->shuffle)
+        return;
+
+    GArray *history = queue->history;
+    if (queue->cursor + 1 < history->len && g_array_index(history, gint, queue->cursor + 1) == current) {
+        queue->cursor++;
+    } else if (queue->cursor > 0 && g_array_index(history, gint, queue->cursor - 1) == current) {
+        queue->cursor--;
+    } else if (history->len == 0) {
+        play_queue_history_push(queue, current);
+        queue->cursor = 0;
+    } else {
+        // Listeden seçilen ya da kuyruktan gelen parça çalanın ardına girer
+        g_array_insert_val(history, queue->cursor + 1, current);
+        queue->cursor++;
+    }
+    play_queue_mark_drawn(queue, current);
+}
+
+/*
+ * Çalan parçadan ahead adım sonraki parça (1: sonraki); yoksa -1.
+ * automatic: parça kendiliğinden bitiyor (tekrar modu uygulanır).
+ */
+static int play_queue_peek(PlayerData *data, int ahead, gboolean automatic) {
+    PlayQueue *queue = &data->queue;
+    int count = playlist_store_count(data->playlist);
+
+    play_queue_sync(data);
+    if (count == 0)
+        return -1;
+    if (automatic && queue->repeat_one)
+        return data->current_index;
+
+    guint queued = g_queue_get_length(&queue->upcoming);
+    if ((guint)ahead <= queued)
+        return GPOINTER_TO_INT(g_queue_peek_nth(&queue->upcoming, ahead - 1));
+    ahead -= queued;
+
+    if (!queue->shuffle) {
+        int index = queue->anchor + ahead;
+        if (index >= count) {
+            if (!data->loop_enabled)
+                return -1;
+            index %= count;
+        }
+        return index;
+    }
+
+    // Gerekirse yeni parça çekilir; çekilenler history'de sırasını korur
+    while (queue->cursor + ahead >= queue->history->len) {
+        gint position = play_queue_draw(data);
+        if (position < 0)
+            return -1;
+        play_queue_history_push(queue, position);
+    }
+    return g_array_index(queue->history, gint, queue->cursor + ahead);
+}
+
+/* "Önceki" butonunun gideceği parça; yoksa -1 */
+static int play_queue_previous(PlayerData *data) {
+    PlayQueue *queue = &data->queue;
+    int count = playlist_store_count(data->playlist);
+
+    play_queue_sync(data);
+    if (count == 0)
+        return -1;
+    if (queue->shuffle)
+        return queue->cursor > 0 ? g_array_index(queue->history, gint, queue->cursor - 1) : -1;
+    // Kuyruktan çalınan bir parçadan, bırakılan yere dönülür
+    if (data->current_index != queue->anchor)
+        return queue->anchor;
+    if (queue->anchor > 0)
+        return queue->anchor - 1;
+    return data->loop_enabled ? count - 1 : -1;
+}
+
+/*
+ * Çalan parça baştan yeniden başlıyor. Kuyruk çalanın değişmesiyle
+ * ilerlediği için, parça kuyruğun başındaysa burada düşürülür.
+ */
+static void play_queue_restart(PlayerData *data, int index) {
+    PlayQueue *queue = &data->queue;
+
+    if (index == data->current_index && !g_queue_is_empty(&queue->upcoming) &&
+        GPOINTER_TO_INT(g_queue_peek_head(&queue->upcoming)) == index)
+        g_queue_pop_head(&queue->upcoming);
+}
+
+/* Parçayı kullanıcının kuyruğuna ekler: next ise hemen sonra, değilse en sona */
+static void play_queue_add(PlayerData *data, int index, gboolean next) {
+    if (index < 0 || index >= playlist_store_count(data->playlist))
+        return;
+
+    play_queue_sync(data);
+    if (next) {
+        g_queue_push_head(&data->queue.upcoming, GINT_TO_POINTER(index));
+    } else {
+        g_queue_push_tail(&data->queue.upcoming, GINT_TO_POINTER(index));
+    }
+    update_labels_and_buttons(data);
+}
+
+static void player_set_shuffle(PlayerData *data, gboolean shuffle) {
+    PlayQueue *queue = &data->queue;
+
+    if (queue->shuffle == shuffle)
+        return;
+    queue->shuffle = shuffle;
+    // Yeni tur çalan parçadan başlar
+    g_array_set_size(queue->history, 0);
+    queue->cursor = 0;
+    queue->current = -1;
+    play_queue_new_round(queue);
+    update_labels_and_buttons(data);
+}
+
+static void player_set_repeat_one(PlayerData *data, gboolean repeat_one) {
+    data->queue.repeat_one = repeat_one;
+    prepare_gapless_next(data);
+}
+
+static void player_queue_init(PlayerData *data) {
+    PlayQueue *queue = &data->queue;
+
+    g_queue_init(&queue->upcoming);
+    queue->history = g_array_new(FALSE, FALSE, sizeof(gint));
+    queue->at_slot = g_hash_table_new(g_direct_hash, g_direct_equal);
+    queue->slot_of = g_hash_table_new(g_direct_hash, g_direct_equal);
+    queue->rand = g_rand_new();
+    queue->current = -1;
+}
+
+static void on_shuffle_toggled(GtkToggleButton *toggle, gpointer user_data) {
+    player_set_shuffle((PlayerData *)user_data, gtk_toggle_button_get_active(toggle));
+}
+
+static void on_repeat_one_toggled(GtkToggleButton *toggle, gpointer user_data) {
+    player_set_repeat_one((PlayerData *)user_data, gtk_toggle_button_get_active(toggle));
+}
+
+/* Kendiliğinden geçilecek sonraki parçanın indeksi (döngü kapalıyken listenin sonunda -1) */
+static int player_next_index(PlayerData *data) {
+    return play_queue_peek(data, 1, TRUE);
+}
+
+/*
+ * ---- Önden okuma (prefetch) ----
+ * Yavaş disklerde ve ağ bağlantılı klasörlerde parça değişiminde ilk okuma
+ * gecikebilir. Sıradaki PREFETCH_AHEAD parça tek bir işçi thread'inde
+ * page cache'e okunur: posix_fadvise ile çekirdeğe bildirilir, ardından
+ * dosyanın başı gerçekten okunur (fadvise yalnızca bir tavsiyedir).
+ * Parça yüklenirken önden okuması bitmişse isabet (hit), değilse ıska
+ * (miss) sayılır. Pencere dışına çıkan dosyaların okuması yarıda bırakılır.
+ */
+
+#define PREFETCH_AHEAD       2                  // Önden okunacak parça sayısı
+#define PREFETCH_READ_BYTES  (8 * 1024 * 1024)  // Dosya başına okunacak en fazla bayt
+#define PREFETCH_CHUNK       (256 * 1024)
+
+enum {
+    PREFETCH_QUEUED = 1,
+    PREFETCH_DONE
+};
+
+typedef struct {
+    PlayerData *data;
+    gchar      *path;
+} PrefetchJob;
+
+/* Yol hâlâ önden okuma penceresinde mi */
+static gboolean prefetch_wanted(PlayerData *data, const gchar *path) {
+    g_mutex_lock(&data->prefetch_lock);
+    gboolean wanted = g_hash_table_contains(data->prefetch_state, path);
+    g_mutex_unlock(&data->prefetch_lock);
+    return wanted;
+}
+
+static void prefetch_worker(gpointer task, gpointer user_data) {
+    PrefetchJob *job = task;
+    PlayerData *data = job->data;
+    guint64 total = 0;
+    int fd = prefetch_wanted(data, job->path) ? g_open(job->path, O_RDONLY, 0) : -1;
+
+    if (fd >= 0) {
+        gchar *buffer = g_malloc(PREFETCH_CHUNK);
+
+#ifdef POSIX_FADV_WILLNEED
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+        while (total < PREFETCH_READ_BYTES && prefetch_wanted(data, job->path)) {
+            gssize n = read(fd, buffer, PREFETCH_CHUNK);
+            if (n <= 0)
+                break;
+            total += n;
+        }
+        g_free(buffer);
+        close(fd);
+    }
+
+    g_mutex_lock(&data->prefetch_lock);
+    if (g_hash_table_contains(data->prefetch_state, job->path)) {
+        if (fd >= 0) {
+            g_hash_table_insert(data->prefetch_state, g_strdup(job->path), GINT_TO_POINTER(PREFETCH_DONE));
+        } else {
+            g_hash_table_remove(data->prefetch_state, job->path);
+        }
+    }
+    data->prefetch_bytes += total;
+    g_mutex_unlock(&data->prefetch_lock);
+
+    g_free(job->path);
+    g_free(job);
+}
+
+/* Yüklenen parçanın önden okunup okunmadığını sayar */
+static void prefetch_account(PlayerData *data, int index) {
+    const gchar *path = playlist_store_path(data->playlist, index);
+    if (!path)
+        return;
+
+    g_mutex_lock(&data->prefetch_lock);
+    if (GPOINTER_TO_INT(g_hash_table_lookup(data->prefetch_state, path)) == PREFETCH_DONE) {
+        data->prefetch_hits++;
+    } else {
+        data->prefetch_misses++;
+    }
+    g_mutex_unlock(&data->prefetch_lock);
+}
+
+/* Önden okuma penceresini kuyrukta çalan parçanın ardındaki PREFETCH_AHEAD parçaya kaydırır */
+static void prefetch_schedule(PlayerData *data) {
+    int count = playlist_store_count(data->playlist);
+    GHashTable *window = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    GPtrArray *start = g_ptr_array_new();
+
+    int ahead[PREFETCH_AHEAD];
+    for (int i = 0; i < PREFETCH_AHEAD; i++)
+        ahead[i] = i < count - 1 ? play_queue_peek(data, i + 1, TRUE) : -1;
+
+    g_mutex_lock(&data->prefetch_lock);
+    for (int i = 0; i < PREFETCH_AHEAD; i++) {
+        int index = ahead[i];
+        if (index < 0)
+            break;
+        if (index == data->current_index)
+            continue;
+
+        const gchar *path = playlist_store_path(data->playlist, index);
+        gpointer state = g_hash_table_lookup(data->prefetch_state, path);
+        if (!state) {
+            state = GINT_TO_POINTER(PREFETCH_QUEUED);
+            g_ptr_array_add(start, (gpointer)path);
+        }
+        g_hash_table_insert(window, g_strdup(path), state);
+    }
+    // Pencereden çıkanlar düşer; işçi onların okumasını bırakır
+    g_hash_table_unref(data->prefetch_state);
+    data->prefetch_state = window;
+    g_mutex_unlock(&data->prefetch_lock);
+
+    if (start->len > 0 && !data->prefetch_pool) {
+        data->prefetch_pool = g_thread_pool_new(prefetch_worker, NULL, 1, FALSE, NULL);
+    }
+    for (guint i = 0; i < start->len; i++) {
+        PrefetchJob *job = g_new0(PrefetchJob, 1);
+        job->data = data;
+        job->path = g_strdup(g_ptr_array_index(start, i));
+        g_thread_pool_push(data->prefetch_pool, job, NULL);
+    }
+    g_ptr_array_free(start, TRUE);
+}
+
+/*
+ * Boşluksuz geçiş için bir sonraki parçanın URI'sini hazırlar (ana thread).
+ * Mevcut parça, döngü veya gapless ayarı her değiştiğinde çağrılır.
+ */
+static void prepare_gapless_next(PlayerData *data) {
+    int next = data->gapless_enabled && !data->crossfade_enabled ? player_next_index(data) : -1;
+
+    gchar *uri = next >= 0 ? g_strdup(playlist_store_uri(data->playlist, next)) : NULL;
+    gdouble gain = next >= 0 ? player_track_gain(data, next) : 1.0;
+
+    g_mutex_lock(&data->gapless_lock);
+    g_free(data->gapless_uri);
+    data->gapless_uri = uri;
+    data->gapless_index = next;
+    data->gapless_gain = gain;
+    g_mutex_unlock(&data->gapless_lock);
+
+    // Sıradaki parçaları diskten önden oku
+    prefetch_schedule(data);
+}
+
+/* Döngü (loop) toggle butonu tıklandığında çağrılır */
+static void on_loop_toggled(GtkToggleButton *toggle, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    data->loop_enabled = gtk_toggle_button_get_active(toggle);
+    prepare_gapless_next(data);
+}
+
+/* Boşluksuz geçiş toggle butonu tıklandığında çağrılır */
+static void on_gapless_toggled(GtkToggleButton *toggle, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    data->gapless_enabled = gtk_toggle_button_get_active(toggle);
+    prepare_gapless_next(data);
+}
+
+/*
+ * ---- Geçiş (crossfade) ----
+ * İsteğe bağlı mod: playbin yerine iki "deck"li ayrı bir pipeline çalışır.
+ *
+ *   deck A: uridecodebin -> audioconvert -> audioresample -> volume --+
+ *                                                                      +-> audiomixer -> audioconvert -> sink
+ *   deck B: uridecodebin -> audioconvert -> audioresample -> volume --+
+ *
+ * Geçiş EOS ile değil konumla tetiklenir. Sonraki parça geçişten
+ * CROSSFADE_PREROLL_LEAD önce açılır ve ilk buffer'ı volume'un önünde
+ * bloklanarak bekler; CROSSFADE_LINK_LEAD önce mixer'a bağlanır. Pad offset'i
+ * yeni parçanın ilk örneğini, eski parçanın geçiş noktasıyla aynı
+ * running-time'a koyar. Ses seviyesi rampaları volume elemanına kontrol
+ * noktaları olarak verilir ve örnek (sample) bazında uygulanır.
+ * Aynı anda en fazla iki decoder çalışır: geçiş sürerken bir sonraki parça
+ * hazırlanmaz.
+ */
+
+#define CROSSFADE_DEFAULT      (5 * GST_SECOND) // Varsayılan geçiş süresi
+#define CROSSFADE_PREROLL_LEAD (5 * GST_SECOND) // Sonraki deck'in açılması
+#define CROSSFADE_LINK_LEAD    (1 * GST_SECOND) // Mixer'a bağlanma payı
+#define CROSSFADE_RETRY_MS     250              // Konum/süre henüz bilinmiyorsa tekrar dene
+
+typedef struct {
+    Crossfade   *engine;
+    GstElement  *bin;
+    GstElement  *convert;    // Decoder çıkışının bağlandığı ilk eleman
+    GstElement  *volume;
+    GstPad      *src;        // bin'in ghost src pad'i (pad offset burada)
+    GstPad      *block_pad;  // volume'un sink pad'i (ön yükleme bloğu burada)
+    GstPad      *mixer_pad;  // Bağlıysa audiomixer sink pad'i
+    gulong       block_id;   // Ön yükleme blok probe'u (yoksa 0)
+    GstControlSource *ramp;  // volume seviyesinin kontrol noktaları
+    GMutex       lock;       // segment için (streaming thread yazar)
+    GstSegment   segment;    // volume çıkışındaki son segment
+    gint         eos;        // Akış bitti (atomik)
+    int          index;      // Playlist indeksi
+    gdouble      gain;       // Normalizasyon kazancı (doğrusal); rampalar bununla çarpılır
+} CrossfadeDeck;
+
+struct _Crossfade {
+    PlayerData    *data;
+    GstElement    *pipeline;
+    GstElement    *mixer;
+    CrossfadeDeck *current;  // Duyulan (geçişte sesi açılan) deck
+    CrossfadeDeck *next;     // Hazırlanmış, bloklu bekleyen deck
+    CrossfadeDeck *outgoing; // Geçişte sesi kısılan deck
+    GstClockTime   fade;     // Ayarlanan geçiş süresi
+    guint          timer_id; // Sıradaki adımın zamanlayıcısı (yoksa 0)
+
+    /* CPU ölçümü: geçiş sırasındaki kullanım, öncesindeki tek deck'li dönemle kıyaslanır */
+    gint64         solo_wall, solo_cpu;       // Tek deck'li dönemin başlangıcı (µs)
+    gint64         overlap_wall, overlap_cpu; // Geçişin başlangıcı (µs)
+    gdouble        last_solo_cpu;             // Son geçişten önceki CPU kullanımı (%)
+    gdouble        last_overlap_cpu;          // Son geçiş sırasındaki CPU kullanımı (%)
+};
+
+static void crossfade_schedule(Crossfade *xf);
+static void crossfade_deck_free(Crossfade *xf, CrossfadeDeck *deck);
+
+/* İşlemin şimdiye kadar harcadığı CPU zamanı (kullanıcı + sistem, µs) */
+static gint64 process_cpu_time(void) {
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return (gint64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * G_USEC_PER_SEC +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/* (cpu_start, wall_start) anından bu yana ortalama CPU kullanımı (%, tek çekirdek = 100) */
+static gdouble process_cpu_percent(gint64 cpu_start, gint64 wall_start) {
+    gint64 wall = g_get_monotonic_time() - wall_start;
+    return wall > 0 ? 100.0 * (gdouble)(process_cpu_time() - cpu_start) / wall : 0.0;
+}
+
+/* uridecodebin'in ses çıkışını user_data'daki elemana bağlar (görüntü vb. akışlar atlanır) */
+static void decoder_pad_added(GstElement *decoder, GstPad *pad, gpointer user_data) {
+    GstElement *target = user_data;
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+
+    if (!caps)
+        caps = gst_pad_query_caps(pad, NULL);
+
+    if (!gst_caps_is_empty(caps) &&
+        g_str_has_prefix(gst_structure_get_name(gst_caps_get_structure(caps, 0)), "audio/")) {
+        GstPad *sink = gst_element_get_static_pad(target, "sink");
+        if (!gst_pad_is_linked(sink))
+            gst_pad_link(pad, sink);
+        gst_object_unref(sink);
+    }
+    gst_caps_unref(caps);
+}
+
+/* Sesi kısılan deck'in akışı bittiğinde ana thread'de çalışır */
+static gboolean crossfade_on_deck_eos(gpointer user_data) {
+    Crossfade *xf = user_data;
+
+    if (xf->outgoing && g_atomic_int_get(&xf->outgoing->eos)) {
+        xf->last_overlap_cpu = process_cpu_percent(xf->overlap_cpu, xf->overlap_wall);
+        g_debug("Geçiş: CPU %%%.1f (öncesinde %%%.1f)", xf->last_overlap_cpu, xf->last_solo_cpu);
+
+        crossfade_deck_free(xf, xf->outgoing);
+        xf->outgoing = NULL;
+        xf->solo_cpu = process_cpu_time();
+        xf->solo_wall = g_get_monotonic_time();
+        crossfade_schedule(xf);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+/* volume çıkışındaki segment'i saklar ve EOS'u bildirir (streaming thread) */
+static GstPadProbeReturn crossfade_deck_event_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    CrossfadeDeck *deck = user_data;
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+
+    switch (GST_EVENT_TYPE(event)) {
+    case GST_EVENT_SEGMENT:
+        g_mutex_lock(&deck->lock);
+        gst_event_copy_segment(event, &deck->segment);
+        g_mutex_unlock(&deck->lock);
+        break;
+    case GST_EVENT_EOS:
+        g_atomic_int_set(&deck->eos, TRUE);
+        g_idle_add(crossfade_on_deck_eos, deck->engine);
+        break;
+    default:
+        break;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+/* Ön yükleme bloğu: ilk buffer, probe kaldırılana kadar burada bekler */
+static GstPadProbeReturn crossfade_deck_block_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    return GST_PAD_PROBE_OK;
+}
+
+/* index'teki parça için bir deck kurar ve pipeline'a ekler (henüz mixer'a bağlamaz) */
+static CrossfadeDeck *crossfade_deck_new(Crossfade *xf, int index) {
+    const gchar *uri = playlist_store_uri(xf->data->playlist, index);
+    if (!uri)
+        return NULL;
+
+    CrossfadeDeck *deck = g_new0(CrossfadeDeck, 1);
+    deck->engine = xf;
+    deck->index = index;
+    deck->gain = player_track_gain(xf->data, index);
+    g_mutex_init(&deck->lock);
+    gst_segment_init(&deck->segment, GST_FORMAT_UNDEFINED);
+
+    deck->bin = gst_bin_new(NULL);
+    GstElement *decoder = gst_element_factory_make("uridecodebin", NULL);
+    GstElement *resample = gst_element_factory_make("audioresample", NULL);
+    deck->convert = gst_element_factory_make("audioconvert", NULL);
+    deck->volume = gst_element_factory_make("volume", NULL);
+    g_object_set(decoder, "uri", uri, NULL);
+
+    gst_bin_add_many(GST_BIN(deck->bin), decoder, deck->convert, resample, deck->volume, NULL);
+    gst_element_link_many(deck->convert, resample, deck->volume, NULL);
+    g_signal_connect(decoder, "pad-added", G_CALLBACK(decoder_pad_added), deck->convert);
+
+    GstPad *volume_src = gst_element_get_static_pad(deck->volume, "src");
+    gst_pad_add_probe(volume_src, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+                      crossfade_deck_event_probe, deck, NULL);
+    deck->src = gst_ghost_pad_new("src", volume_src);
+    gst_element_add_pad(deck->bin, deck->src);
+    gst_object_unref(volume_src);
+    deck->block_pad = gst_element_get_static_pad(deck->volume, "sink");
+
+    // Ses seviyesi kontrol noktaları arasında doğrusal değişir
+    deck->ramp = gst_interpolation_control_source_new();
+    g_object_set(deck->ramp, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+    gst_object_add_control_binding(GST_OBJECT(deck->volume),
+                                   gst_direct_control_binding_new_absolute(GST_OBJECT(deck->volume),
+                                                                           "volume", deck->ramp));
+
+    gst_bin_add(GST_BIN(xf->pipeline), deck->bin);
+    return deck;
+}
+
+static void crossfade_deck_free(Crossfade *xf, CrossfadeDeck *deck) {
+    if (!deck)
+        return;
+
+    gst_element_set_state(deck->bin, GST_STATE_NULL);
+    if (deck->mixer_pad) {
+        gst_pad_unlink(deck->src, deck->mixer_pad);
+        gst_element_release_request_pad(xf->mixer, deck->mixer_pad);
+        gst_object_unref(deck->mixer_pad);
+    }
+    gst_object_unref(deck->block_pad);
+    gst_object_unref(deck->ramp);
+    gst_bin_remove(GST_BIN(xf->pipeline), deck->bin);
+    g_mutex_clear(&deck->lock);
+    g_free(deck);
+}
+
+static void crossfade_deck_link(Crossfade *xf, CrossfadeDeck *deck) {
+    deck->mixer_pad = gst_element_request_pad_simple(xf->mixer, "sink_%u");
+    gst_pad_link(deck->src, deck->mixer_pad);
+}
+
+/* Deck'in seviyesini start anında from'dan start + length anında to'ya getirir (deck'in stream-time'ı) */
+static void crossfade_deck_ramp(CrossfadeDeck *deck, GstClockTime start, GstClockTime length,
+                                gdouble from, gdouble to) {
+    GstTimedValueControlSource *source = GST_TIMED_VALUE_CONTROL_SOURCE(deck->ramp);
+
+    gst_timed_value_control_source_unset_all(source);
+    gst_timed_value_control_source_set(source, start, from * deck->gain);
+    if (length > 0) {
+        gst_timed_value_control_source_set(source, start + length, to * deck->gain);
+    }
+}
+
+/* Deck'in konumu ve süresi (decoder'dan, stream-time); istenmeyen için NULL verilebilir */
+static gboolean crossfade_deck_query(CrossfadeDeck *deck, gint64 *position, gint64 *duration) {
+    GstPad *sink = gst_element_get_static_pad(deck->convert, "sink");
+    gboolean ok = (!position || gst_pad_peer_query_position(sink, GST_FORMAT_TIME, position)) &&
+                  (!duration || (gst_pad_peer_query_duration(sink, GST_FORMAT_TIME, duration) &&
+                                 *duration > 0));
+    gst_object_unref(sink);
+    return ok;
+}
+
+/* Kısa parçalarda geçiş, parçanın yarısını geçmez */
+static GstClockTime crossfade_effective_fade(Crossfade *xf, gint64 duration) {
+    return MIN(xf->fade, (GstClockTime)duration / 2);
+}
+
+static void crossfade_unschedule(Crossfade *xf) {
+    if (xf->timer_id) {
+        g_source_remove(xf->timer_id);
+        xf->timer_id = 0;
+    }
+}
+
+/* Tüm deck'leri kaldırır (pipeline NULL durumundayken çağrılır) */
+static void crossfade_reset(Crossfade *xf) {
+    crossfade_unschedule(xf);
+    crossfade_deck_free(xf, xf->outgoing);
+    crossfade_deck_free(xf, xf->next);
+    crossfade_deck_free(xf, xf->current);
+    xf->outgoing = xf->next = xf->current = NULL;
+}
+
+/* Pipeline durmuşken index'teki parçayı tek deck olarak yükler */
+static gboolean crossfade_load(Crossfade *xf, int index) {
+    crossfade_reset(xf);
+    xf->current = crossfade_deck_new(xf, index);
+    if (!xf->current)
+        return FALSE;
+
+    crossfade_deck_ramp(xf->current, 0, 0, 1.0, 1.0);
+    crossfade_deck_link(xf, xf->current);
+    xf->solo_cpu = process_cpu_time();
+    xf->solo_wall = g_get_monotonic_time();
+    return TRUE;
+}
+
+/* Sonraki parçayı açar; ilk buffer'ı volume'un önünde bekletilir */
+static void crossfade_prepare_next(Crossfade *xf) {
+    int index = player_next_index(xf->data);
+    if (index < 0)
+        return;
+
+    CrossfadeDeck *deck = crossfade_deck_new(xf, index);
+    if (!deck)
+        return;
+
+    crossfade_deck_ramp(deck, 0, 0, 0.0, 0.0);
+    deck->block_id = gst_pad_add_probe(deck->block_pad,
+                                       GST_PAD_PROBE_TYPE_BLOCK | GST_PAD_PROBE_TYPE_BUFFER |
+                                       GST_PAD_PROBE_TYPE_BUFFER_LIST,
+                                       crossfade_deck_block_probe, NULL, NULL);
+    gst_element_sync_state_with_parent(deck->bin);
+    xf->next = deck;
+}
+
+/*
+ * Hazırlanmış deck'i mixer'a bağlar ve iki rampayı kurar. Rampalar her
+ * deck'in kendi stream-time'ında verilir; yeni deck'in offset'i, ilk
+ * örneğini eski deck'in geçiş noktasının running-time'ına kaydırır.
+ */
+static void crossfade_start_fade(Crossfade *xf) {
+    CrossfadeDeck *out = xf->current;
+    CrossfadeDeck *in = xf->next;
+    GstSegment out_segment, in_segment;
+    gint64 duration;
+
+    if (!crossfade_deck_query(out, NULL, &duration))
+        return;
+
+    g_mutex_lock(&out->lock);
+    out_segment = out->segment;
+    g_mutex_unlock(&out->lock);
+    g_mutex_lock(&in->lock);
+    in_segment = in->segment;
+    g_mutex_unlock(&in->lock);
+
+    GstClockTime fade = crossfade_effective_fade(xf, duration);
+    GstClockTime fade_at = (GstClockTime)duration - fade;
+    GstClockTime start = out_segment.format == GST_FORMAT_TIME
+        ? gst_segment_to_running_time(&out_segment, GST_FORMAT_TIME, fade_at)
+        : GST_CLOCK_TIME_NONE;
+
+    // Geçiş noktası geride kaldıysa (ör. sona yakın seek) parça EOS ile değişir
+    if (!GST_CLOCK_TIME_IS_VALID(start))
+        return;
+    start += gst_pad_get_offset(out->src);
+
+    GstClockTime in_start = 0, in_running = 0;
+    if (in_segment.format == GST_FORMAT_TIME) {
+        in_start = in_segment.start;
+        in_running = gst_segment_to_running_time(&in_segment, GST_FORMAT_TIME, in_start);
+    }
+
+    crossfade_deck_ramp(out, fade_at, fade, 1.0, 0.0);
+    crossfade_deck_ramp(in, in_start, fade, 0.0, 1.0);
+    gst_pad_set_offset(in->src, (gint64)start - (gint64)in_running);
+    crossfade_deck_link(xf, in);
+    gst_pad_remove_probe(in->block_pad, in->block_id);
+    in->block_id = 0;
+
+    xf->last_solo_cpu = process_cpu_percent(xf->solo_cpu, xf->solo_wall);
+    xf->overlap_cpu = process_cpu_time();
+    xf->overlap_wall = g_get_monotonic_time();
+
+    xf->outgoing = out;
+    xf->current = in;
+    xf->next = NULL;
+
+    PlayerData *data = xf->data;
+    if (!data->queue.repeat_one)
+        play_queue_restart(data, in->index);
+    data->current_index = in->index;
+    data->duration = GST_CLOCK_TIME_NONE;
+    update_labels_and_buttons(data);
+}
+
+static gboolean crossfade_timer_cb(gpointer user_data) {
+    Crossfade *xf = user_data;
+
+    xf->timer_id = 0;
+    crossfade_schedule(xf);
+    return G_SOURCE_REMOVE;
+}
+
+static void crossfade_arm(Crossfade *xf, gint64 wait) {
+    xf->timer_id = g_timeout_add((guint)(wait / GST_MSECOND), crossfade_timer_cb, xf);
+}
+
+/*
+ * Sıradaki adımı (sonraki deck'i açma ya da geçişi başlatma) zamanlar; vakti
+ * geldiyse hemen yapar. Çalma başladığında, seek/preroll bittiğinde ve bir
+ * geçiş tamamlandığında çağrılır.
+ */
+static void crossfade_schedule(Crossfade *xf) {
+    int next_index = player_next_index(xf->data);
+    gint64 position, duration;
+
+    crossfade_unschedule(xf);
+    if (!xf->current || xf->outgoing || !xf->data->is_playing)
+        return;
+
+    // Liste ya da döngü ayarı değiştiyse hazırlanan deck artık geçersiz
+    if (xf->next && xf->next->index != next_index) {
+        crossfade_deck_free(xf, xf->next);
+        xf->next = NULL;
+    }
+    if (next_index < 0)
+        return;
+
+    if (!crossfade_deck_query(xf->current, &position, &duration)) {
+        xf->timer_id = g_timeout_add(CROSSFADE_RETRY_MS, crossfade_timer_cb, xf);
+        return;
+    }
+
+    // Geçiş noktasına kalan süre
+    gint64 remaining = duration - (gint64)crossfade_effective_fade(xf, duration) - position;
+
+    if (!xf->next) {
+        if (remaining > (gint64)CROSSFADE_PREROLL_LEAD) {
+            crossfade_arm(xf, remaining - CROSSFADE_PREROLL_LEAD);
+            return;
+        }
+        crossfade_prepare_next(xf);
+        if (!xf->next)
+            return;
+    }
+
+    if (remaining > (gint64)CROSSFADE_LINK_LEAD) {
+        crossfade_arm(xf, remaining - CROSSFADE_LINK_LEAD);
+        return;
+    }
+    crossfade_start_fade(xf);
+}
+
+/* Zaman seek'i gönderir; olayın sıra numarasını döndürür (gönderilemediyse 0) */
+static guint32 pipeline_seek(GstElement *pipeline, gint64 position, GstSeekFlags flags) {
+    GstEvent *event = gst_event_new_seek(1.0, GST_FORMAT_TIME, flags, GST_SEEK_TYPE_SET, position,
+                                         GST_SEEK_TYPE_NONE, GST_CLOCK_TIME_NONE);
+    guint32 seqnum = gst_event_get_seqnum(event);
+
+    return gst_element_send_event(pipeline, event) ? seqnum : 0;
+}
+
+/*
+ * Yalnızca duyulan deck kalır ve tüm pipeline flush'lı seek yapar; running-time
+ * sıfırdan başladığı için deck'in offset'i de sıfırlanır.
+ */
+static guint32 crossfade_seek(Crossfade *xf, gint64 position, GstSeekFlags flags) {
+    crossfade_unschedule(xf);
+    crossfade_deck_free(xf, xf->outgoing);
+    crossfade_deck_free(xf, xf->next);
+    xf->outgoing = xf->next = NULL;
+    if (!xf->current)
+        return 0;
+
+    crossfade_deck_ramp(xf->current, 0, 0, 1.0, 1.0);
+    gst_pad_set_offset(xf->current->src, 0);
+    return pipeline_seek(xf->pipeline, position, flags | GST_SEEK_FLAG_FLUSH);
+}
+
+static gboolean crossfade_bus_callback(GstBus *bus, GstMessage *msg, gpointer user_data) {
+    Crossfade *xf = (Crossfade *)user_data;
+    PlayerData *data = xf->data;
+
+    if (data->crossfade_enabled)
+        stats_handle_message(data, msg);
+    if (player_message_stale(data, msg))
+        return TRUE;
+
+    switch (GST_MESSAGE_TYPE(msg)) {
+    case GST_MESSAGE_EOS:
+        // Son parça bitti ya da geçiş yapılamadı: normal geçiş
+        player_advance(data, TRUE);
+        break;
+    case GST_MESSAGE_ASYNC_DONE:
+        // Açılış ya da seek tamamlandı, konum artık sorgulanabilir
+        session_seek_restored(data);
+        crossfade_schedule(xf);
+        break;
+    case GST_MESSAGE_DURATION_CHANGED:
+        data->duration = GST_CLOCK_TIME_NONE;
+        break;
+    case GST_MESSAGE_ERROR:
+    {
+        GError *err;
+        gchar *debug_info;
+        gst_message_parse_error(msg, &err, &debug_info);
+        g_printerr("Hata: %s\n", err->message);
+        g_error_free(err);
+        g_free(debug_info);
+
+        // Hazırlanan parça açılamadıysa yalnızca o bırakılır, çalan parça sürer
+        if (xf->next && gst_object_has_as_ancestor(GST_MESSAGE_SRC(msg), GST_OBJECT(xf->next->bin))) {
+            crossfade_deck_free(xf, xf->next);
+            xf->next = NULL;
+        } else {
+            stop_media(data);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return TRUE;
+}
+
+/* Geçiş motorunu kurar; gerekli elemanlardan biri yoksa NULL döner */
+static Crossfade *crossfade_new(PlayerData *data) {
+    static const gchar *factories[] = { "uridecodebin", "audioconvert", "audioresample",
+                                        "volume", "audiomixer", "capsfilter" };
+
+    for (guint i = 0; i < G_N_ELEMENTS(factories); i++) {
+        GstElementFactory *factory = gst_element_factory_find(factories[i]);
+        if (!factory) {
+            g_printerr("Hata: Geçiş için '%s' elemanı bulunamadı.\n", factories[i]);
+            return NULL;
+        }
+        gst_object_unref(factory);
+    }
+
+    GstElement *sink = gst_element_factory_make(data->audio_sink_name, NULL);
+    if (!sink) {
+        g_printerr("Hata: Geçiş için ses sink'i oluşturulamadı.\n");
+        return NULL;
+    }
+
+    Crossfade *xf = g_new0(Crossfade, 1);
+    xf->data = data;
+    xf->fade = CROSSFADE_DEFAULT;
+    xf->pipeline = gst_pipeline_new("crossfade");
+    xf->mixer = gst_element_factory_make("audiomixer", "mixer");
+    GstElement *convert = gst_element_factory_make("audioconvert", NULL);
+    GstElement *eq_caps = equalizer_caps_filter();
+
+    // Ekolayzer mixer'ın F32 çıkışında çalışır
+    gst_bin_add_many(GST_BIN(xf->pipeline), xf->mixer, eq_caps, convert, sink, NULL);
+    gst_element_link_many(xf->mixer, eq_caps, convert, sink, NULL);
+    equalizer_attach(data, eq_caps);
+
+    g_signal_connect(xf->pipeline, "deep-element-added", G_CALLBACK(stats_on_element_added), &data->stats);
+    g_signal_connect(xf->pipeline, "deep-element-added", G_CALLBACK(seek_index_on_element_added), data);
+
+    GstBus *bus = gst_element_get_bus(xf->pipeline);
+    gst_bus_set_sync_handler(bus, player_bus_stamp, data, NULL);
+    gst_bus_add_watch(bus, crossfade_bus_callback, xf);
+    gst_object_unref(bus);
+    return xf;
+}
+
+/*
+ * Geçiş modunu açar/kapatır ve süresini ayarlar (0 < seconds). Mod
+ * değişirse çalma diğer pipeline'a taşınır ve mevcut parça baştan yüklenir.
+ */
+static void player_set_crossfade(PlayerData *data, gboolean enabled, gdouble seconds) {
+    if (enabled && !data->crossfade) {
+        data->crossfade = crossfade_new(data);
+        if (!data->crossfade)
+            return;
+    }
+    if (data->crossfade) {
+        data->crossfade->fade = (GstClockTime)(MAX(seconds, 0.0) * GST_SECOND);
+    }
+
+    if (enabled == data->crossfade_enabled) {
+        if (enabled)
+            crossfade_schedule(data->crossfade);
+        return;
+    }
+
+    gboolean was_playing = data->is_playing;
+    stop_media(data);
+    // playbin ses aygıtını bırakmadan diğer pipeline başlamasın
+    player_control_sync(data);
+    data->crossfade_enabled = enabled;
+    data->pipeline = enabled ? data->crossfade->pipeline : data->playbin;
+
+    if (playlist_store_count(data->playlist) > 0 && player_load(data, data->current_index) && was_playing) {
+        play_media(data);
+    }
+    prepare_gapless_next(data);
+}
+
+static void on_crossfade_changed(GtkWidget *widget, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    player_set_crossfade(data, gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(data->crossfade_toggle)),
+                         gtk_spin_button_get_value(GTK_SPIN_BUTTON(data->crossfade_spin)));
+    if (data->crossfade_enabled != gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(data->crossfade_toggle))) {
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(data->crossfade_toggle), data->crossfade_enabled);
+    }
+}
+
+/* Parçayı etkin pipeline'a yükler (pipeline durmuşken çağrılır) */
+static gboolean player_load(PlayerData *data, int index) {
+    prefetch_account(data, index);
+
+    if (data->crossfade_enabled)
+        return crossfade_load(data->crossfade, index);
+
+    const gchar *uri = playlist_store_uri(data->playlist, index);
+    if (!uri)
+        return FALSE;
+    player_control_push(data, CONTROL_LOAD, uri, player_track_gain(data, index));
+    return TRUE;
+}
+
+/* Çalan parçanın konumu; geçiş modunda mixer'ın değil duyulan deck'in konumu */
+static gboolean player_query_position(PlayerData *data, gint64 *position) {
+    if (data->crossfade_enabled)
+        return data->crossfade->current && crossfade_deck_query(data->crossfade->current, position, NULL);
+    return gst_element_query_position(data->pipeline, GST_FORMAT_TIME, position);
+}
+
+static gboolean player_query_duration(PlayerData *data, gint64 *duration) {
+    if (data->crossfade_enabled)
+        return data->crossfade->current && crossfade_deck_query(data->crossfade->current, NULL, duration);
+    return gst_element_query_duration(data->pipeline, GST_FORMAT_TIME, duration);
+}
+
+/* Playlist'teki satıra çift tık (row-activated) yapıldığında çağrılır */
+static void on_playlist_row_activated(GtkTreeView *view, GtkTreePath *path,
+                                      GtkTreeViewColumn *column, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    int row = gtk_tree_path_get_indices(path)[0];
+
+    if (row < 0 || row >= playlist_model_row_count(data->playlist_model))
+        return;
+
+    int index = playlist_model_position(data->playlist_model, row);
+    if (index >= 0 && index < playlist_store_count(data->playlist)) {
+        stop_media(data);
+        data->current_index = index;
+
+        if (player_load(data, data->current_index)) {
+            play_media(data);
+        }
+        update_labels_and_buttons(data);
+    }
+}
+
+/* Playlist satırına sağ tık: kuyruk menüsü o satır için açılır */
+static gboolean on_playlist_button_press(GtkWidget *view, GdkEventButton *event, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    GtkTreePath *path;
+
+    if (event->type != GDK_BUTTON_PRESS || event->button != GDK_BUTTON_SECONDARY)
+        return FALSE;
+    if (!gtk_tree_view_get_path_at_pos(GTK_TREE_VIEW(view), (gint)event->x, (gint)event->y,
+                                       &path, NULL, NULL, NULL))
+        return FALSE;
+
+    int row = gtk_tree_path_get_indices(path)[0];
+    gtk_tree_path_free(path);
+    data->queue_menu_position = playlist_model_position(data->playlist_model, row);
+    gtk_menu_popup_at_pointer(GTK_MENU(data->queue_menu), (GdkEvent *)event);
+    return TRUE;
+}
+
+static void on_queue_play_next(GtkMenuItem *item, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    play_queue_add(data, data->queue_menu_position, TRUE);
+}
+
+static void on_queue_add(GtkMenuItem *item, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    play_queue_add(data, data->queue_menu_position, FALSE);
+}
+
+/*
+ * Liste içeriği ya da arama metni değiştiğinde çağrılır.
+ * Satır widget'ı oluşturulmaz; yalnızca süzgece girip çıkan satırlar
+ * görünüme bildirilir, böylece kaydırma ve seçim korunur. Konumlar
+ * kaydıysa (silme, yeni liste) ya da fark çok büyükse model
+ * görünüme yeniden bağlanır. GtkTreeView yalnızca görünen satırları çizer.
+ */
+static void refresh_playlist(PlayerData *data) {
+    if (!data->playlist_view)
+        return;
+
+    GtkTreeView *view = GTK_TREE_VIEW(data->playlist_view);
+    PlaylistModel *model = data->playlist_model;
+    const gchar *query = data->search_entry ? gtk_entry_get_text(GTK_ENTRY(data->search_entry)) : "";
+    GArray *old_filter = model->filter;
+    gint old_rows = model->shown;
+
+    // Arama metni varsa süzgeci indeksten yeniden hesapla (eski süzgeç farka kadar korunur)
+    if (*query) {
+        if (!data->search_index) {
+            data->search_index = search_index_new();
+            data->search_results = g_array_new(FALSE, FALSE, sizeof(guint32));
+        }
+        if (!data->search_previous)
+            data->search_previous = g_array_new(FALSE, FALSE, sizeof(guint32));
+        GArray *results = data->search_previous;
+        data->search_previous = data->search_results;
+        data->search_results = results;
+        search_index_query(data->search_index, data->playlist, query, data->search_results);
+        model->filter = data->search_results;
+    } else {
+        model->filter = NULL;
+    }
+
+    // Eski iter'leri geçersiz kıl
+    model->stamp++;
+
+    if (model->revision != data->playlist->revision
+        || !playlist_model_apply_delta(model, old_filter, old_rows)) {
+        model->revision = data->playlist->revision;
+        model->shown = playlist_model_row_count(model);
+        gtk_tree_view_set_model(view, NULL);
+        gtk_tree_view_set_model(view, GTK_TREE_MODEL(model));
+    } else {
+        // Kalan satırların içeriği (ör. vurgu) değişmiş olabilir
+        gtk_widget_queue_draw(data->playlist_view);
+    }
+    data->highlighted_index = data->current_index;
+}
+
+/* Arama metni değişti: süzgeç indeksten yeniden hesaplanır */
+static void on_search_changed(GtkSearchEntry *entry, gpointer user_data) {
+    refresh_playlist((PlayerData *)user_data);
+}
+
+/* Arama kutusunda Enter: ilk sonuç satır aktivasyonuyla aynı yoldan çalınır */
+static void on_search_activate(GtkEntry *entry, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    if (playlist_model_row_count(data->playlist_model) == 0)
+        return;
+
+    GtkTreePath *path = gtk_tree_path_new_from_indices(0, -1);
+    on_playlist_row_activated(GTK_TREE_VIEW(data->playlist_view), path, NULL, data);
+    gtk_tree_path_free(path);
+}
+
+/*
+ * Şarkı değiştiğinde vurguyu eski satırdan yeni satıra taşır.
+ * Yalnızca bu iki satır yeniden çizilir.
+ */
+static void highlight_current_row(PlayerData *data) {
+    int old_index = data->highlighted_index;
+
+    data->highlighted_index = data->current_index;
+    playlist_model_row_changed(data->playlist_model, old_index);
+    if (data->current_index != old_index) {
+        playlist_model_row_changed(data->playlist_model, data->current_index);
+    }
+
+    // Çalan satırı görünür alana getir (süzgeçte görünüyorsa)
+    int row = data->current_index >= 0 && data->current_index < playlist_store_count(data->playlist)
+              ? playlist_model_row_of(data->playlist_model, data->current_index) : -1;
+    if (row >= 0) {
+        GtkTreePath *path = gtk_tree_path_new_from_indices(row, -1);
+        gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(data->playlist_view), path, NULL, FALSE, 0, 0);
+        gtk_tree_path_free(path);
+    }
+}
+
+/* Etiketleri ve butonları günceller. */
+static void update_labels_and_buttons(PlayerData *data) {
+    int count = playlist_store_count(data->playlist);
+
+    // Boşluksuz geçiş için sonraki parçayı hazırla
+    prepare_gapless_next(data);
+
+    // Headless modda yalnızca çalan parçayı bildir
+    if (!data->window) {
+        if (count > 0) {
+            g_print("Şu an çalan: %s\n", playlist_store_path(data->playlist, data->current_index));
+        }
+        return;
+    }
+
+    // Şimdiki şarkı
+    gtk_label_set_text(GTK_LABEL(data->current_label),
+                       count > 0
+                           ? playlist_store_basename(data->playlist, data->current_index)
+                           : "Şu an çalan: Yok");
+
+    // Önceki ve sonraki şarkı: kuyruktaki gerçek komşular
+    int previous = count > 1 ? play_queue_previous(data) : -1;
+    int next = count > 1 ? play_queue_peek(data, 1, FALSE) : -1;
+
+    if (previous >= 0) {
+        gtk_label_set_text(GTK_LABEL(data->previous_label),
+                           playlist_store_basename(data->playlist, previous));
+        gtk_widget_set_sensitive(data->previous_button, TRUE);
+    } else {
+        gtk_label_set_text(GTK_LABEL(data->previous_label), "Önceki: Yok");
+        gtk_widget_set_sensitive(data->previous_button, FALSE);
+    }
+
+    if (next >= 0) {
+        gtk_label_set_text(GTK_LABEL(data->next_label),
+                           playlist_store_basename(data->playlist, next));
+        gtk_widget_set_sensitive(data->next_button, TRUE);
+    } else {
+        gtk_label_set_text(GTK_LABEL(data->next_label), "Sonraki: Yok");
+        gtk_widget_set_sensitive(data->next_button, FALSE);
+    }
+
+    update_play_button(data);
+
+    // Playlistte vurguyu taşı
+    highlight_current_row(data);
+
+    // Slider arkasındaki dalga formu
+    waveform_request(data);
+}
+
+/* Eğer oynuyorsa buton ikonu pause, duraklatılmışsa play göster */
+static void update_play_button(PlayerData *data) {
+    if (!data->play_button)
+        return;
+
+    gtk_button_set_image(GTK_BUTTON(data->play_button),
+                         gtk_image_new_from_icon_name(data->is_playing
+                                                          ? "media-playback-pause-symbolic"
+                                                          : "media-playback-start-symbolic",
+                                                      GTK_ICON_SIZE_BUTTON));
+}
+
+/* Etkin pipeline'ın durumunu değiştirir; playbin için kontrol thread'ine bırakılır */
+static void player_set_state(PlayerData *data, GstState state) {
+    if (data->crossfade_enabled) {
+        // Eşzamanlı: NULL'a inince eski akış bitmiştir, nesil hemen ilerler
+        stats_set_state(&data->stats, data->pipeline, state);
+        if (state == GST_STATE_NULL)
+            g_atomic_int_set(&data->control.applied, (gint)++data->control.generation);
+        return;
+    }
+    player_control_push(data, state == GST_STATE_PLAYING ? CONTROL_PLAY
+                              : state == GST_STATE_PAUSED ? CONTROL_PAUSE
+                              : CONTROL_STOP, NULL, 0);
+}
+
+/* Müzik oynat/duraklat fonksiyonu */
+static void play_media(PlayerData *data) {
+    if (!data->pipeline) {
+        g_print("Hata: Pipeline başlatılmadı!\n");
+        return;
+    }
+
+    if (!data->is_playing) {
+        player_set_state(data, GST_STATE_PLAYING);
+        data->is_playing = TRUE;
+        update_play_button(data);
+        position_updates_start(data);
+        if (data->crossfade_enabled)
+            crossfade_schedule(data->crossfade);
+    } else {
+        player_set_state(data, GST_STATE_PAUSED);
+        data->is_playing = FALSE;
+        if (data->crossfade_enabled)
+            crossfade_unschedule(data->crossfade);
+        position_updates_stop(data);
+        update_play_button(data);
+    }
+}
+
+/* Müzik durdurma fonksiyonu */
+static void stop_media(PlayerData *data) {
+    if (data->pipeline) {
+        player_set_state(data, GST_STATE_NULL);
+    }
+    if (data->crossfade_enabled) {
+        crossfade_reset(data->crossfade);
+    }
+    data->is_playing = FALSE;
+    data->duration = GST_CLOCK_TIME_NONE;
+    data->restore_position = GST_CLOCK_TIME_NONE;
+    position_updates_stop(data);
+
+    // Kuyruğa alınmış geçiş artık geçersiz (geçiş ölçümü kontrol thread'inde sıfırlanır)
+    g_mutex_lock(&data->gapless_lock);
+    data->queued_index = -1;
+    g_mutex_unlock(&data->gapless_lock);
+
+    update_play_button(data);
+    if (data->slider) {
+        gtk_range_set_value(GTK_RANGE(data->slider), 0);
+    }
+}
+
+/* Slider'ı ve zaman etiketini günceller (konum tick'inden çağrılır) */
+static void update_slider(PlayerData *data) {
+    // Kullanıcı slider'ı tutarken ya da seek beklerken konumu ezme
+    if (data->seek_dragging || data->seek_pending)
+        return;
+
+    // Süre parça başına bir kez sorgulanır
+    if (!GST_CLOCK_TIME_IS_VALID(data->duration)) {
+        gint64 duration = -1;
+        if (!player_query_duration(data, &duration) || duration < 0)
+            return;
+        data->duration = (GstClockTime)duration;
+        gtk_range_set_range(GTK_RANGE(data->slider), 0, (gdouble)duration / GST_SECOND);
+    }
+
+    gint64 position = -1;
+    gint64 duration = (gint64)data->duration;
+
+    if (player_query_position(data, &position)) {
+        gtk_range_set_value(GTK_RANGE(data->slider), (gdouble)position / GST_SECOND);
+
+        gint64 pos_minutes = position / (GST_SECOND * 60);
+        gint64 pos_seconds = (position / GST_SECOND) % 60;
+        gint64 dur_minutes = duration / (GST_SECOND * 60);
+        gint64 dur_seconds = (duration / GST_SECOND) % 60;
+
+        gchar *time_text = g_strdup_printf("%02lld:%02lld / %02lld:%02lld",
+                                           pos_minutes, pos_seconds,
+                                           dur_minutes, dur_seconds);
+        gtk_label_set_text(GTK_LABEL(data->time_label), time_text);
+        g_free(time_text);
+    }
+}
+
+/*
+ * Konum güncelleme aralığı: slider'da bir pikselin karşılığı olan süre,
+ * 33 ms (~30 fps) ile 500 ms (zaman etiketi için) arasında sınırlanır.
+ */
+static gint64 position_update_interval(PlayerData *data) {
+    gint width = gtk_widget_get_allocated_width(data->slider);
+
+    if (!GST_CLOCK_TIME_IS_VALID(data->duration) || width <= 0)
+        return 500 * 1000;
+    return CLAMP((gint64)(data->duration / GST_USECOND) / width, 33 * 1000, 500 * 1000);
+}
+
+/* Frame clock her karede çağırır; güncelleme aralığı dolduysa konumu yeniler */
+static gboolean position_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    gint64 now = gdk_frame_clock_get_frame_time(frame_clock);
+
+    if (now - data->position_updated >= position_update_interval(data)) {
+        data->position_updated = now;
+        update_slider(data);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+/* Çalarken ve pencere görünürken konum tick'ini kaydeder (en fazla bir tane) */
+static void position_updates_start(PlayerData *data) {
+    if (!data->slider || data->position_tick_id || !data->is_playing || data->window_hidden)
+        return;
+
+    data->position_updated = 0;
+    data->position_tick_id = gtk_widget_add_tick_callback(data->slider, position_tick, data, NULL);
+}
+
+static void position_updates_stop(PlayerData *data) {
+    if (data->position_tick_id) {
+        gtk_widget_remove_tick_callback(data->slider, data->position_tick_id);
+        data->position_tick_id = 0;
+    }
+}
+
+/* Pencere simge durumuna küçültüldüğünde ya da gizlendiğinde konum güncellemesini askıya alır */
+static gboolean on_window_state_event(GtkWidget *widget, GdkEventWindowState *event, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    data->window_hidden = (event->new_window_state &
+                           (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN)) != 0;
+    if (data->window_hidden) {
+        position_updates_stop(data);
+    } else {
+        position_updates_start(data);
+    }
+    return FALSE;
+}
+
+/* Pipeline'a seek gönderen tek yer; gönderilen seek'ler sayılır */
+static void seek_to_position(PlayerData *data, gdouble seconds, GstSeekFlags flags) {
+    if (!data->pipeline)
+        return;
+
+    gint64 position = (gint64)(MAX(seconds, 0.0) * GST_SECOND);
+    guint32 seqnum;
+
+    // Yükleme henüz uygulanmadıysa seek kaybolurdu; yeni parça hazır olunca (ASYNC_DONE) yapılır
+    if (player_control_stale(data)) {
+        data->restore_position = (GstClockTime)position;
+        return;
+    }
+
+    if (data->crossfade_enabled) {
+        seqnum = crossfade_seek(data->crossfade, position, flags);
+    } else {
+        seqnum = pipeline_seek(data->pipeline, position, flags);
+    }
+    data->seek_count++;
+    if ((flags & GST_SEEK_FLAG_FLUSH) && seqnum) {
+        data->stats.seek_requested = g_get_monotonic_time();
+        data->stats.seek_seqnum = seqnum;
+    }
+}
+
+/*
+ * Bekleyen seek'i bir sonraki karede uygular. Sürükleme sırasında hızlı
+ * (anahtar kareye yaslanan), bırakıldıktan sonra tam konumlu seek yapılır.
+ */
+static gboolean seek_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    if (data->seek_pending) {
+        GstSeekFlags flags = data->seek_dragging
+            ? GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_NEAREST
+            : GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE;
+        seek_to_position(data, data->seek_target, flags);
+        data->seek_pending = FALSE;
+    }
+
+    data->seek_tick_id = 0;
+    return G_SOURCE_REMOVE;
+}
+
+/* Seek hedefini kaydeder; aynı karedeki hedefler tek seek'te birleşir */
+static void schedule_seek(PlayerData *data, gdouble seconds) {
+    data->seek_target = seconds;
+    data->seek_pending = TRUE;
+    if (!data->seek_tick_id) {
+        data->seek_tick_id = gtk_widget_add_tick_callback(data->slider, seek_tick, data, NULL);
+    }
+}
+
+/* Slider kullanıcı tarafından hareket ettirildiğinde çağrılır (programatik değişimlerde değil) */
+static gboolean on_slider_change_value(GtkRange *range, GtkScrollType scroll,
+                                       gdouble value, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    GtkAdjustment *adjustment = gtk_range_get_adjustment(range);
+
+    schedule_seek(data, CLAMP(value, gtk_adjustment_get_lower(adjustment),
+                              gtk_adjustment_get_upper(adjustment)));
+    return FALSE;
+}
+
+static gboolean on_slider_button_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    data->seek_dragging = TRUE;
+    return FALSE;
+}
+
+/* Sürükleme bitti: son konuma tam (accurate) seek yapılır */
+static gboolean on_slider_button_release(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    if (data->seek_dragging) {
+        data->seek_dragging = FALSE;
+        schedule_seek(data, data->seek_pending ? data->seek_target
+                                               : gtk_range_get_value(GTK_RANGE(widget)));
+    }
+    return FALSE;
+}
+
+/*
+ * Kuyruktaki sonraki şarkıya geçer (bkz. "Çalma kuyruğu").
+ * automatic -> TRUE ise parça kendiliğinden bitti; tekrar modunda aynı parça baştan çalar.
+ * Sıradaki parça yoksa (döngü kapalı, liste/tur bitti) durur.
+ */
+static void player_advance(PlayerData *data, gboolean automatic) {
+    if (playlist_store_count(data->playlist) == 0 || (automatic && data->hold_on_eos))
+        return;
+
+    int next = play_queue_peek(data, 1, automatic);
+    stop_media(data);
+    if (next < 0)
+        return;
+    if (!automatic || !data->queue.repeat_one)
+        play_queue_restart(data, next);
+
+    data->current_index = next;
+    if (player_load(data, data->current_index)) {
+        play_media(data);
+        update_labels_and_buttons(data);
+    }
+}
+
+/* Sonraki şarkıya geç ("Sonraki" butonu; tekrar modu atlanır) */
+static void next_media(PlayerData *data) {
+    player_advance(data, FALSE);
+}
+
+/* Önceki şarkıya geç (karışık çalmada çalınmış bir önceki parça) */
+static void previous_media(PlayerData *data) {
+    int previous = play_queue_previous(data);
+
+    if (previous >= 0) {
+        stop_media(data);
+        data->current_index = previous;
+
+        if (player_load(data, data->current_index)) {
+            play_media(data);
+            update_labels_and_buttons(data);
+        }
+    }
+}
+
+/* Listeyi verilen yollarla değiştirir ve görünümü yeniler (çalmayı başlatmaz) */
+static void playlist_replace(PlayerData *data, GSList *files) {
+    playlist_store_clear(data->playlist);
+    for (GSList *node = files; node != NULL; node = node->next) {
+        playlist_store_append(data->playlist, (gchar *)node->data, NULL, NULL, GST_CLOCK_TIME_NONE);
+    }
+
+    data->current_index = 0;
+    refresh_playlist(data);
+}
+
+/* Dosyalar seçildiğinde çağrılır */
+static void file_chosen(GtkWidget *widget, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    GtkFileChooser *chooser = GTK_FILE_CHOOSER(widget);
+    GSList *files = gtk_file_chooser_get_filenames(chooser);
+
+    if (files != NULL) {
+        stop_media(data);
+
+        // Eski listeyi temizle ve yenisini oluştur
+        playlist_replace(data, files);
+        g_slist_free_full(files, g_free);
+
+        // İlk şarkıyı yükle ve çal
+        if (player_load(data, data->current_index)) {
+            play_media(data);
+        }
+        update_labels_and_buttons(data);
+    }
+}
+
+/* Dosya seçme diyalogunu açar */
+static void choose_file(GtkWidget *button, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    GtkWidget *dialog = gtk_file_chooser_dialog_new("Dosya Seç",
+                                                    GTK_WINDOW(gtk_widget_get_toplevel(button)),
+                                                    GTK_FILE_CHOOSER_ACTION_OPEN,
+                                                    "İptal", GTK_RESPONSE_CANCEL,
+                                                    "Seç", GTK_RESPONSE_ACCEPT,
+                                                    NULL);
+
+    GtkFileFilter *filter = gtk_file_filter_new();
+    gtk_file_filter_set_name(filter, "MP3 Dosyaları");
+    gtk_file_filter_add_pattern(filter, "*.mp3");
+    gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+    gtk_file_chooser_set_select_multiple(GTK_FILE_CHOOSER(dialog), TRUE);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        file_chosen(dialog, data);
+    }
+
+    gtk_widget_destroy(dialog);
+}
+
+/*
+ * ---- Klasör taraması ----
+ * Seçilen klasörler ayrı bir thread'de gezilir; bulunan her dosya bir
+ * GThreadPool'a verilir. İşçi thread'ler dosyanın mtime/boyutunu diskteki
+ * indeksle karşılaştırır, değişmişse GstDiscoverer ile etiket ve süreyi
+ * çıkarır. Sonuçlar ana thread'de toplu halde playliste eklenir ve tarama
+ * bitince indeks diske yazılır.
+ */
+
+#define LIBRARY_INDEX_HEADER   "MP3PLAYER-LIBRARY 1"
+#define LIBRARY_FLUSH_INTERVAL 100 // ms, sonuçların playliste aktarılma aralığı
+
+/* İndeksteki bir dosyanın kaydı */
+typedef struct {
+    gchar       *path;
+    gint64       mtime;
+    gint64       size;
+    GstClockTime duration;
+    gchar       *title;
+    gchar       *artist;
+} ScanEntry;
+
+struct _LibraryScan {
+    PlayerData  *data;
+    GThreadPool *pool;
+    GHashTable  *index;     // data->library_index; tarama boyunca salt okunur
+    gchar      **roots;
+
+    GMutex       lock;      // pending ve walk_done'ı korur
+    GPtrArray   *pending;   // Ana thread'e aktarılmayı bekleyen ScanEntry'ler
+    gboolean     walk_done; // Klasörler gezildi ve tüm işler bitti
+
+    GPtrArray   *results;   // Playliste eklenmiş kayıtlar (bitince indekse taşınır)
+    gint         hits;      // İndeksten gelen (değişmemiş) dosya sayısı
+    gint         misses;    // Yeniden analiz edilen dosya sayısı
+    gint64       start_time;
+};
+
+/* Her işçi thread'inin kendi GstDiscoverer'ı (ilk ihtiyaçta oluşturulur) */
+static GPrivate scan_discoverer = G_PRIVATE_INIT(g_object_unref);
+
+static void scan_entry_free(gpointer p) {
+    ScanEntry *entry = p;
+    g_free(entry->path);
+    g_free(entry->title);
+    g_free(entry->artist);
+    g_free(entry);
+}
+
+static gchar *library_index_path(void) {
+    return g_build_filename(g_get_user_cache_dir(), "mp3_player", "library.idx", NULL);
+}
+
+/* İndeks satırındaki metinler için: sekme, satır sonu ve ters bölü kaçırılır */
+static void library_index_append_escaped(GString *out, const gchar *text) {
+    for (const gchar *c = text ? text : ""; *c; c++) {
+        switch (*c) {
+        case '\\': g_string_append(out, "\\\\"); break;
+        case '\t':  g_string_append(out, "\\t"); break;
+        case '\n':  g_string_append(out, "\\n"); break;
+        default:    g_string_append_c(out, *c); break;
+        }
+    }
+}
+
+/*
+ * İndeks dosyasını yükler. Her satır:
+ *   mtime \t boyut \t süre(ns, -1: bilinmiyor) \t yol \t başlık \t sanatçı
+ */
+static GHashTable *library_index_load(void) {
+    GHashTable *index = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, scan_entry_free);
+    gchar *path = library_index_path();
+    gchar *contents = NULL;
+    gsize length = 0;
+
+    if (g_file_get_contents(path, &contents, &length, NULL) &&
+        g_str_has_prefix(contents, LIBRARY_INDEX_HEADER "\n")) {
+        gchar *line = contents + strlen(LIBRARY_INDEX_HEADER "\n");
+
+        while (*line) {
+            gchar *end = strchr(line, '\n');
+            if (end)
+                *end = '\0';
+
+            gchar **fields = g_strsplit(line, "\t", 6);
+            if (g_strv_length(fields) == 6) {
+                ScanEntry *entry = g_new0(ScanEntry, 1);
+                gint64 duration = g_ascii_strtoll(fields[2], NULL, 10);
+
+                entry->mtime = g_ascii_strtoll(fields[0], NULL, 10);
+                entry->size = g_ascii_strtoll(fields[1], NULL, 10);
+                entry->duration = duration >= 0 ? (GstClockTime)duration : GST_CLOCK_TIME_NONE;
+                entry->path = g_strcompress(fields[3]);
+                entry->title = *fields[4] ? g_strcompress(fields[4]) : NULL;
+                entry->artist = *fields[5] ? g_strcompress(fields[5]) : NULL;
+                g_hash_table_replace(index, entry->path, entry);
+            }
+            g_strfreev(fields);
+
+            if (!end)
+                break;
+            line = end + 1;
+        }
+    }
+
+    g_free(contents);
+    g_free(path);
+    return index;
+}
+
+static void library_index_save(GHashTable *index) {
+    GString *out = g_string_sized_new(g_hash_table_size(index) * 128);
+    GHashTableIter iter;
+    gpointer value;
+
+    g_string_append(out, LIBRARY_INDEX_HEADER "\n");
+    g_hash_table_iter_init(&iter, index);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        ScanEntry *entry = value;
+        g_string_append_printf(out, "%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t",
+                               entry->mtime, entry->size,
+                               GST_CLOCK_TIME_IS_VALID(entry->duration) ? (gint64)entry->duration : -1);
+        library_index_append_escaped(out, entry->path);
+        g_string_append_c(out, '\t');
+        library_index_append_escaped(out, entry->title);
+        g_string_append_c(out, '\t');
+        library_index_append_escaped(out, entry->artist);
+        g_string_append_c(out, '\n');
+    }
+
+    gchar *path = library_index_path();
+    gchar *dir = g_path_get_dirname(path);
+    GError *err = NULL;
+
+    g_mkdir_with_parents(dir, 0755);
+    if (!g_file_set_contents(path, out->str, out->len, &err)) {
+        g_printerr("Hata: Tarama indeksi yazılamadı: %s\n", err->message);
+        g_error_free(err);
+    }
+
+    g_free(dir);
+    g_free(path);
+    g_string_free(out, TRUE);
+}
+
+/* GstDiscoverer ile dosyanın süresini ve etiketlerini okur (işçi thread) */
+static void scan_discover(ScanEntry *entry) {
+    GstDiscoverer *discoverer = g_private_get(&scan_discoverer);
+    if (!discoverer) {
+        discoverer = gst_discoverer_new(5 * GST_SECOND, NULL);
+        if (!discoverer)
+            return;
+        g_private_set(&scan_discoverer, discoverer);
+    }
+
+    gchar *uri = g_filename_to_uri(entry->path, NULL, NULL);
+    if (!uri)
+        return;
+
+    GstDiscovererInfo *info = gst_discoverer_discover_uri(discoverer, uri, NULL);
+    if (info) {
+        if (gst_discoverer_info_get_result(info) == GST_DISCOVERER_OK) {
+            const GstTagList *tags = gst_discoverer_info_get_tags(info);
+
+            entry->duration = gst_discoverer_info_get_duration(info);
+            if (tags) {
+                gst_tag_list_get_string(tags, GST_TAG_TITLE, &entry->title);
+                gst_tag_list_get_string(tags, GST_TAG_ARTIST, &entry->artist);
+            }
+        }
+        gst_discoverer_info_unref(info);
+    }
+    g_free(uri);
+}
+
+/* Havuzdaki işçi: tek bir dosyayı işler */
+static void scan_worker(gpointer task, gpointer user_data) {
+    LibraryScan *scan = user_data;
+    gchar *path = task;
+    GStatBuf st;
+
+    if (g_stat(path, &st) != 0) {
+        g_free(path);
+        return;
+    }
+
+    ScanEntry *entry = g_new0(ScanEntry, 1);
+    ScanEntry *cached = g_hash_table_lookup(scan->index, path);
+
+    entry->path = path;
+    entry->mtime = st.st_mtime;
+    entry->size = st.st_size;
+    entry->duration = GST_CLOCK_TIME_NONE;
+
+    if (cached && cached->mtime == entry->mtime && cached->size == entry->size) {
+        // Dosya değişmemiş: indeksteki bilgiyi kullan
+        entry->duration = cached->duration;
+        entry->title = g_strdup(cached->title);
+        entry->artist = g_strdup(cached->artist);
+        g_atomic_int_inc(&scan->hits);
+    } else {
+        scan_discover(entry);
+        g_atomic_int_inc(&scan->misses);
+    }
+
+    g_mutex_lock(&scan->lock);
+    g_ptr_array_add(scan->pending, entry);
+    g_mutex_unlock(&scan->lock);
+}
+
+static gboolean scan_is_audio_file(const gchar *name) {
+    static const gchar *extensions[] = { ".mp3", ".flac", ".ogg", ".opus", ".m4a", ".wav", NULL };
+    gchar *lower = g_ascii_strdown(name, -1);
+    gboolean match = FALSE;
+
+    for (int i = 0; extensions[i] && !match; i++) {
+        match = g_str_has_suffix(lower, extensions[i]);
+    }
+    g_free(lower);
+    return match;
+}
+
+/* Klasörü özyinelemeli gezer, ses dosyalarını havuza verir */
+static void scan_walk(LibraryScan *scan, const gchar *dir_path) {
+    GDir *dir = g_dir_open(dir_path, 0, NULL);
+    if (!dir)
+        return;
+
+    const gchar *name;
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        gchar *path = g_build_filename(dir_path, name, NULL);
+
+        if (g_file_test(path, G_FILE_TEST_IS_DIR)) {
+            if (!g_file_test(path, G_FILE_TEST_IS_SYMLINK))
+                scan_walk(scan, path);
+            g_free(path);
+        } else if (scan_is_audio_file(name)) {
+            g_thread_pool_push(scan->pool, path, NULL);
+        } else {
+            g_free(path);
+        }
+    }
+    g_dir_close(dir);
+}
+
+/* Gezinti thread'i: klasörleri dolaşır, sonra tüm işlerin bitmesini bekler */
+static gpointer scan_walker_thread(gpointer user_data) {
+    LibraryScan *scan = user_data;
+
+    for (int i = 0; scan->roots[i]; i++) {
+        scan_walk(scan, scan->roots[i]);
+    }
+    g_thread_pool_free(scan->pool, FALSE, TRUE);
+    scan->pool = NULL;
+
+    g_mutex_lock(&scan->lock);
+    scan->walk_done = TRUE;
+    g_mutex_unlock(&scan->lock);
+    return NULL;
+}
+
+/* Bekleyen sonuçları ana thread'de playliste ekler; tarama bitince kapatır */
+static gboolean library_scan_flush(gpointer user_data) {
+    LibraryScan *scan = user_data;
+    PlayerData *data = scan->data;
+
+    g_mutex_lock(&scan->lock);
+    GPtrArray *batch = scan->pending;
+    gboolean done = scan->walk_done;
+    scan->pending = g_ptr_array_new();
+    g_mutex_unlock(&scan->lock);
+
+    if (batch->len > 0) {
+        gboolean was_empty = playlist_store_count(data->playlist) == 0;
+        gboolean at_end = data->current_index >= playlist_store_count(data->playlist) - 1;
+
+        for (guint i = 0; i < batch->len; i++) {
+            ScanEntry *entry = g_ptr_array_index(batch, i);
+            playlist_store_append(data->playlist, entry->path, entry->title, entry->artist, entry->duration);
+            if (data->playlist_model) {
+                playlist_model_row_inserted(data->playlist_model, playlist_store_count(data->playlist) - 1);
+            }
+            g_ptr_array_add(scan->results, entry);
+        }
+        // Arama sürüyorsa yeni parçalar süzgeçten geçirilerek gösterilir
+        if (data->playlist_model && data->playlist_model->filter) {
+            refresh_playlist(data);
+        }
+
+        if (was_empty) {
+            // Liste boştuysa dosya seçiminde olduğu gibi ilk parçayı çal
+            data->current_index = 0;
+            if (player_load(data, 0)) {
+                play_media(data);
+            }
+            update_labels_and_buttons(data);
+        } else if (at_end) {
+            // Son parçadaydık: "Sonraki" etiketi ve boşluksuz geçiş değişti
+            update_labels_and_buttons(data);
+        }
+    }
+    g_ptr_array_free(batch, TRUE);
+
+    if (!done)
+        return G_SOURCE_CONTINUE;
+
+    // Tarama bitti: sonuçları indekse taşı ve diske yaz
+    for (guint i = 0; i < scan->results->len; i++) {
+        ScanEntry *entry = g_ptr_array_index(scan->results, i);
+        g_hash_table_replace(scan->index, entry->path, entry);
+    }
+    library_index_save(scan->index);
+
+    g_print("Tarama bitti: %u dosya (%d indeksten, %d yeniden analiz) %.2f sn\n",
+            scan->results->len, scan->hits, scan->misses,
+            (g_get_monotonic_time() - scan->start_time) / (gdouble)G_USEC_PER_SEC);
+
+    g_ptr_array_free(scan->results, TRUE);
+    g_ptr_array_free(scan->pending, TRUE);
+    g_mutex_clear(&scan->lock);
+    g_strfreev(scan->roots);
+    g_free(scan);
+    data->library_scan = NULL;
+    return G_SOURCE_REMOVE;
+}
+
+/* Verilen klasörlerin arkaplanda taranmasını başlatır; sonuçlar playliste eklenir */
+static void library_scan_start(PlayerData *data, gchar **roots) {
+    if (data->library_scan) {
+        g_print("Bir klasör taraması zaten sürüyor.\n");
+        g_strfreev(roots);
+        return;
+    }
+
+    if (!data->library_index) {
+        data->library_index = library_index_load();
+    }
+
+    LibraryScan *scan = g_new0(LibraryScan, 1);
+    scan->data = data;
+    scan->index = data->library_index;
+    scan->roots = roots;
+    scan->pending = g_ptr_array_new();
+    scan->results = g_ptr_array_new();
+    scan->start_time = g_get_monotonic_time();
+    g_mutex_init(&scan->lock);
+    scan->pool = g_thread_pool_new(scan_worker, scan, (gint)g_get_num_processors(), FALSE, NULL);
+    data->library_scan = scan;
+
+    g_timeout_add(LIBRARY_FLUSH_INTERVAL, library_scan_flush, scan);
+    g_thread_unref(g_thread_new("library-scan", scan_walker_thread, scan));
+}
+
+/* Klasör seçme diyalogunu açar ve seçilen klasörleri tarar */
+static void choose_folder(GtkWidget *button, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    GtkWidget *dialog = gtk_file_chooser_dialog_new("Klasör Seç",
+                                                    GTK_WINDOW(gtk_widget_get_toplevel(button)),
+                                                    GTK_FILE_CHOOSER_ACTION_SELECT_FOLDER,
+                                                    "İptal", GTK_RESPONSE_CANCEL,
+                                                    "Tara", GTK_RESPONSE_ACCEPT,
+                                                    NULL);
+    gtk_file_chooser_set_select_multiple(GTK_FILE_CHOOSER(dialog), TRUE);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        GSList *folders = gtk_file_chooser_get_filenames(GTK_FILE_CHOOSER(dialog));
+        gchar **roots = g_new0(gchar *, g_slist_length(folders) + 1);
+        int i = 0;
+
+        for (GSList *node = folders; node != NULL; node = node->next) {
+            roots[i++] = node->data;
+        }
+        g_slist_free(folders);
+        library_scan_start(data, roots);
+    }
+
+    gtk_widget_destroy(dialog);
+}
+
+/*
+ * Dosyayı çalmadan, saat beklemeden F32 (interleaved) örneklere çözer. Her
+ * buffer fakesink'in "handoff" sinyaliyle handoff'a verilir. Çağıran
+ * thread'de EOS'a kadar bloklar; dosya sonuna kadar çözülebildiyse TRUE.
+ */
+static gboolean decode_file_f32(const gchar *path, GCallback handoff, gpointer user_data) {
+    gchar *uri = g_filename_to_uri(path, NULL, NULL);
+    if (!uri)
+        return FALSE;
+
+    GstElement *pipeline = gst_pipeline_new(NULL);
+    GstElement *decoder = gst_element_factory_make("uridecodebin", NULL);
+    GstElement *convert = gst_element_factory_make("audioconvert", NULL);
+    GstElement *filter = gst_element_factory_make("capsfilter", NULL);
+    GstElement *sink = gst_element_factory_make("fakesink", NULL);
+    gboolean ok = FALSE;
+
+    if (decoder && convert && filter && sink) {
+        GstCaps *caps = gst_caps_from_string("audio/x-raw,format=F32LE,layout=interleaved");
+        g_object_set(filter, "caps", caps, NULL);
+        gst_caps_unref(caps);
+        g_object_set(decoder, "uri", uri, NULL);
+        g_object_set(sink, "sync", FALSE, "signal-handoffs", TRUE, NULL);
+        g_signal_connect(sink, "handoff", handoff, user_data);
+        g_signal_connect(decoder, "pad-added", G_CALLBACK(decoder_pad_added), convert);
+
+        gst_bin_add_many(GST_BIN(pipeline), decoder, convert, filter, sink, NULL);
+        gst_element_link_many(convert, filter, sink, NULL);
+
+        GstBus *bus = gst_element_get_bus(pipeline);
+        gst_element_set_state(pipeline, GST_STATE_PLAYING);
+        GstMessage *msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+                                                     GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+        ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+        if (msg)
+            gst_message_unref(msg);
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(bus);
+    } else {
+        // Eksik elemanlar pipeline'a eklenmediği için tek tek bırakılır
+        GstElement *elements[] = { decoder, convert, filter, sink };
+        for (guint i = 0; i < G_N_ELEMENTS(elements); i++) {
+            if (elements[i])
+                gst_object_unref(gst_object_ref_sink(elements[i]));
+        }
+    }
+    gst_object_unref(pipeline);
+    g_free(uri);
+    return ok;
+}
+
+/*
+ * ---- Ses yüksekliği analizi ----
+ * Playlistteki her dosya, çekirdek sayısı kadar işçi thread'i olan bir
+ * GThreadPool'da çözülür ve EBU R128 / ITU-R BS.1770'e göre entegre ses
+ * yüksekliği (K ağırlıklı, 400 ms bloklar, -70 LUFS mutlak ve -10 LU göreli
+ * kapı) ile 4x aradeğerlemeli gerçek tepe (true peak) ölçülür. Sonuçlar
+ * mtime/boyut ile birlikte diskteki önbelleğe yazılır; değişmemiş dosyalar
+ * yeniden çözülmez. Çalarken yalnızca önbellekteki kazanç uygulanır.
+ */
+
+#define LOUDNESS_INDEX_HEADER "MP3PLAYER-LOUDNESS 1"
+#define LOUDNESS_TARGET       -18.0 // LUFS, ReplayGain 2.0 referans seviyesi
+#define LOUDNESS_TP_TAPS      12    // Gerçek tepe aradeğerleme çekirdeğinin uzunluğu (örnek)
+
+/* Önbellekteki bir dosyanın ölçümü */
+typedef struct {
+    gchar  *path;
+    gint64  mtime;
+    gint64  size;
+    gdouble loudness; // Entegre ses yüksekliği (LUFS; sessiz dosyada -inf)
+    gdouble peak;     // Gerçek tepe (doğrusal, 1.0 = 0 dBTP)
+} LoudnessEntry;
+
+struct _LoudnessAnalysis {
+    PlayerData  *data;
+    GThreadPool *pool;
+
+    GMutex       lock;     // pending'i korur
+    GPtrArray   *pending;  // Ana thread'e aktarılmayı bekleyen LoudnessEntry'ler
+    gint         total;    // Havuza verilen dosya sayısı
+    gint         finished; // Biten iş sayısı (atomik)
+    gint         hits;     // Önbellekten gelen (değişmemiş) dosya sayısı
+    gint         misses;   // Ölçülen dosya sayısı
+    gint64       start_time;
+};
+
+/* İkinci dereceden IIR filtre (a0 = 1) */
+typedef struct {
+    gdouble b0, b1, b2, a1, a2;
+} Biquad;
+
+/* Tek bir dosyanın ölçüm durumu; fakesink handoff'unda (streaming thread) güncellenir */
+typedef struct {
+    gint     rate;
+    gint     channels;
+    Biquad   shelf;      // K ağırlığı: yüksek raf
+    Biquad   highpass;   // K ağırlığı: RLB yüksek geçiren
+    gdouble *state;      // Kanal başına 4 filtre durumu
+    gfloat  *history;    // Kanal başına 2 x LOUDNESS_TP_TAPS örneklik halka
+    gint     history_pos;
+    gint     sub_size;   // 100 ms'lik alt bloğun örnek sayısı
+    gint     sub_fill;
+    gdouble  sub_sum;
+    gdouble  subs[4];    // Son dört alt bloğun kare toplamı
+    guint    sub_count;
+    GArray  *blocks;     // 400 ms'lik blokların ortalama karesi (gdouble)
+    gdouble  peak;
+} LoudnessMeter;
+
+/* Gerçek tepe için 4x aradeğerleme katsayıları (1/4, 2/4, 3/4 fazları) */
+static gdouble loudness_tp_coeffs[3][LOUDNESS_TP_TAPS];
+
+static gpointer loudness_tp_init(gpointer unused) {
+    for (int phase = 0; phase < 3; phase++) {
+        for (int j = 0; j < LOUDNESS_TP_TAPS; j++) {
+            // Hann pencereli sinc; nokta, halkanın ortasındaki iki örnek arasında
+            gdouble x = (LOUDNESS_TP_TAPS / 2 - 1) + (phase + 1) / 4.0 - j;
+            gdouble sinc = x == 0.0 ? 1.0 : sin(G_PI * x) / (G_PI * x);
+            gdouble window = 0.5 * (1.0 + cos(G_PI * x / (LOUDNESS_TP_TAPS / 2)));
+            loudness_tp_coeffs[phase][j] = sinc * window;
+        }
+    }
+    return NULL;
+}
+
+/* BS.1770 K ağırlık filtrelerini örnekleme hızına göre hesaplar */
+static void loudness_meter_init(LoudnessMeter *meter, gint rate, gint channels) {
+    gdouble K, Q, Vh, Vb, a0;
+
+    meter->rate = rate;
+    meter->channels = channels;
+
+    K = tan(G_PI * 1681.974450955533 / rate);
+    Q = 0.7071752369554196;
+    Vh = pow(10.0, 3.999843853973347 / 20.0);
+    Vb = pow(Vh, 0.4996667741545416);
+    a0 = 1.0 + K / Q + K * K;
+    meter->shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+    meter->shelf.b1 = 2.0 * (K * K - Vh) / a0;
+    meter->shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+    meter->shelf.a1 = 2.0 * (K * K - 1.0) / a0;
+    meter->shelf.a2 = (1.0 - K / Q + K * K) / a0;
+
+    K = tan(G_PI * 38.13547087602444 / rate);
+    Q = 0.5003270373238773;
+    a0 = 1.0 + K / Q + K * K;
+    meter->highpass.b0 = 1.0;
+    meter->highpass.b1 = -2.0;
+    meter->highpass.b2 = 1.0;
+    meter->highpass.a1 = 2.0 * (K * K - 1.0) / a0;
+    meter->highpass.a2 = (1.0 - K / Q + K * K) / a0;
+
+    meter->state = g_new0(gdouble, channels * 4);
+    meter->history = g_new0(gfloat, channels * 2 * LOUDNESS_TP_TAPS);
+    meter->sub_size = MAX(rate / 10, 1);
+}
+
+static inline gdouble biquad_process(const Biquad *f, gdouble *z, gdouble x) {
+    gdouble y = f->b0 * x + z[0];
+    z[0] = f->b1 * x - f->a1 * y + z[1];
+    z[1] = f->b2 * x - f->a2 * y;
+    return y;
+}
+
+/* Örneği halkaya yazar ve önceki iki örnek arasındaki üç aradeğerin tepesini döndürür */
+static inline gdouble loudness_true_peak(LoudnessMeter *meter, gint channel, gfloat sample) {
+    gfloat *ring = meter->history + channel * 2 * LOUDNESS_TP_TAPS;
+    gint pos = meter->history_pos;
+    gdouble peak = 0.0;
+
+    // Halka iki kez yazılır; böylece son LOUDNESS_TP_TAPS örnek hep ardışıktır
+    ring[pos] = ring[pos + LOUDNESS_TP_TAPS] = sample;
+    const gfloat *window = ring + pos + 1;
+
+    for (int phase = 0; phase < 3; phase++) {
+        gdouble value = 0.0;
+        for (int j = 0; j < LOUDNESS_TP_TAPS; j++) {
+            value += loudness_tp_coeffs[phase][j] * window[j];
+        }
+        peak = MAX(peak, fabs(value));
+    }
+    return peak;
+}
+
+static void loudness_meter_process(LoudnessMeter *meter, const gfloat *samples, gsize frames) {
+    for (gsize i = 0; i < frames; i++) {
+        for (gint c = 0; c < meter->channels; c++) {
+            gfloat x = samples[i * meter->channels + c];
+            gdouble *z = meter->state + c * 4;
+            gdouble y = biquad_process(&meter->highpass, z + 2, biquad_process(&meter->shelf, z, x));
+
+            meter->sub_sum += y * y;
+            meter->peak = MAX(meter->peak, fabs(x));
+            meter->peak = MAX(meter->peak, loudness_true_peak(meter, c, x));
+        }
+        meter->history_pos = (meter->history_pos + 1) % LOUDNESS_TP_TAPS;
+
+        // 100 ms doldu: son dört alt blok bir 400 ms'lik bloğu (%75 örtüşme) oluşturur
+        if (++meter->sub_fill == meter->sub_size) {
+            meter->subs[meter->sub_count++ % 4] = meter->sub_sum;
+            meter->sub_sum = 0.0;
+            meter->sub_fill = 0;
+
+            if (meter->sub_count >= 4) {
+                gdouble z = (meter->subs[0] + meter->subs[1] + meter->subs[2] + meter->subs[3]) /
+                            (4.0 * meter->sub_size);
+                g_array_append_val(meter->blocks, z);
+            }
+        }
+    }
+}
+
+/* Kapılı entegre ses yüksekliği (LUFS); hiç blok kapıyı geçmezse -inf */
+static gdouble loudness_meter_integrated(LoudnessMeter *meter) {
+    const gdouble absolute_gate = pow(10.0, (-70.0 + 0.691) / 10.0);
+    gdouble sum = 0.0, relative_gate;
+    guint count = 0;
+
+    for (guint i = 0; i < meter->blocks->len; i++) {
+        gdouble z = g_array_index(meter->blocks, gdouble, i);
+        if (z > absolute_gate) {
+            sum += z;
+            count++;
+        }
+    }
+    if (count == 0)
+        return -INFINITY;
+
+    relative_gate = sum / count * 0.1; // -10 LU
+    sum = 0.0;
+    count = 0;
+    for (guint i = 0; i < meter->blocks->len; i++) {
+        gdouble z = g_array_index(meter->blocks, gdouble, i);
+        if (z > absolute_gate && z > relative_gate) {
+            sum += z;
+            count++;
+        }
+    }
+    return count > 0 ? -0.691 + 10.0 * log10(sum / count) : -INFINITY;
+}
+
+static void loudness_handoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer user_data) {
+    LoudnessMeter *meter = user_data;
+    GstMapInfo map;
+
+    if (meter->rate == 0) {
+        GstCaps *caps = gst_pad_get_current_caps(pad);
+        gint rate = 0, channels = 0;
+
+        if (caps) {
+            GstStructure *s = gst_caps_get_structure(caps, 0);
+            gst_structure_get_int(s, "rate", &rate);
+            gst_structure_get_int(s, "channels", &channels);
+            gst_caps_unref(caps);
+        }
+        if (rate <= 0 || channels <= 0)
+            return;
+        loudness_meter_init(meter, rate, channels);
+    }
+
+    if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        loudness_meter_process(meter, (const gfloat *)map.data,
+                               map.size / (sizeof(gfloat) * meter->channels));
+        gst_buffer_unmap(buffer, &map);
+    }
+}
+
+/* Dosyayı çözerek ölçer (işçi thread); çözülemezse FALSE */
+static gboolean loudness_measure(LoudnessEntry *entry) {
+    static GOnce tp_once = G_ONCE_INIT;
+    g_once(&tp_once, loudness_tp_init, NULL);
+
+    LoudnessMeter meter = { 0 };
+    meter.blocks = g_array_new(FALSE, FALSE, sizeof(gdouble));
+
+    gboolean ok = decode_file_f32(entry->path, G_CALLBACK(loudness_handoff), &meter) && meter.rate > 0;
+    if (ok) {
+        entry->loudness = loudness_meter_integrated(&meter);
+        entry->peak = meter.peak;
+    }
+    g_array_free(meter.blocks, TRUE);
+    g_free(meter.state);
+    g_free(meter.history);
+    return ok;
+}
+
+static void loudness_entry_free(gpointer p) {
+    LoudnessEntry *entry = p;
+    g_free(entry->path);
+    g_free(entry);
+}
+
+static gchar *loudness_index_path(void) {
+    return g_build_filename(g_get_user_cache_dir(), "mp3_player", "loudness.idx", NULL);
+}
+
+/*
+ * Önbellek dosyasını yükler. Her satır:
+ *   mtime \t boyut \t ses yüksekliği (LUFS) \t gerçek tepe \t yol
+ */
+static GHashTable *loudness_index_load(void) {
+    GHashTable *index = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, loudness_entry_free);
+    gchar *path = loudness_index_path();
+    gchar *contents = NULL;
+
+    if (g_file_get_contents(path, &contents, NULL, NULL) &&
+        g_str_has_prefix(contents, LOUDNESS_INDEX_HEADER "\n")) {
+        gchar *line = contents + strlen(LOUDNESS_INDEX_HEADER "\n");
+
+        while (*line) {
+            gchar *end = strchr(line, '\n');
+            if (end)
+                *end = '\0';
+
+            gchar **fields = g_strsplit(line, "\t", 5);
+            if (g_strv_length(fields) == 5) {
+                LoudnessEntry *entry = g_new0(LoudnessEntry, 1);
+
+                entry->mtime = g_ascii_strtoll(fields[0], NULL, 10);
+                entry->size = g_ascii_strtoll(fields[1], NULL, 10);
+                entry->loudness = g_ascii_strtod(fields[2], NULL);
+                entry->peak = g_ascii_strtod(fields[3], NULL);
+                entry->path = g_strcompress(fields[4]);
+                g_hash_table_replace(index, entry->path, entry);
+            }
+            g_strfreev(fields);
+
+            if (!end)
+                break;
+            line = end + 1;
+        }
+    }
+
+    g_free(contents);
+    g_free(path);
+    return index;
+}
+
+static void loudness_index_save(GHashTable *index) {
+    GString *out = g_string_sized_new(g_hash_table_size(index) * 96);
+    gchar loudness[G_ASCII_DTOSTR_BUF_SIZE], peak[G_ASCII_DTOSTR_BUF_SIZE];
+    GHashTableIter iter;
+    gpointer value;
+
+    g_string_append(out, LOUDNESS_INDEX_HEADER "\n");
+    g_hash_table_iter_init(&iter, index);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        LoudnessEntry *entry = value;
+        g_string_append_printf(out, "%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%s\t%s\t",
+                               entry->mtime, entry->size,
+                               g_ascii_dtostr(loudness, sizeof(loudness), entry->loudness),
+                               g_ascii_dtostr(peak, sizeof(peak), entry->peak));
+        library_index_append_escaped(out, entry->path);
+        g_string_append_c(out, '\n');
+    }
+
+    gchar *path = loudness_index_path();
+    gchar *dir = g_path_get_dirname(path);
+    GError *err = NULL;
+
+    g_mkdir_with_parents(dir, 0755);
+    if (!g_file_set_contents(path, out->str, out->len, &err)) {
+        g_printerr("Hata: Ses yüksekliği önbelleği yazılamadı: %s\n", err->message);
+        g_error_free(err);
+    }
+
+    g_free(dir);
+    g_free(path);
+    g_string_free(out, TRUE);
+}
+
+/*
+ * Parçanın normalizasyon kazancı (doğrusal). Ölçüm yoksa ya da
+ * normalizasyon kapalıysa 1.0. Kazanç, gerçek tepeyi 0 dBTP'nin üstüne
+ * çıkaracak kadar büyütülmez.
+ */
+static gdouble player_track_gain(PlayerData *data, int index) {
+    gdouble gain_db = 0.0;
+
+    if (!data->normalize_enabled || !data->loudness_index ||
+        index < 0 || index >= playlist_store_count(data->playlist))
+        return 1.0;
+
+    g_mutex_lock(&data->loudness_lock);
+    LoudnessEntry *entry = g_hash_table_lookup(data->loudness_index,
+                                               playlist_store_path(data->playlist, index));
+    if (entry && isfinite(entry->loudness)) {
+        gain_db = LOUDNESS_TARGET - entry->loudness;
+        if (entry->peak > 0.0)
+            gain_db = MIN(gain_db, -20.0 * log10(entry->peak));
+    }
+    g_mutex_unlock(&data->loudness_lock);
+
+    return CLAMP(pow(10.0, gain_db / 20.0), 0.0, 10.0);
+}
+
+/* Çalan (ve boşluksuz kuyruğa alınacak) parçanın kazancını yeniden uygular */
+static void player_apply_gain(PlayerData *data) {
+    gdouble gain = player_track_gain(data, data->current_index);
+
+    if (data->crossfade_enabled) {
+        Crossfade *xf = data->crossfade;
+        // Geçiş sürerken rampalara dokunulmaz; sonraki parçada uygulanır
+        if (xf->current && !xf->outgoing) {
+            xf->current->gain = gain;
+            crossfade_deck_ramp(xf->current, 0, 0, 1.0, 1.0);
+        }
+    } else if (data->normalize_volume) {
+        g_object_set(data->normalize_volume, "volume", gain, NULL);
+    }
+    prepare_gapless_next(data);
+}
+
+/*
+ * Boşluksuz geçişte kuyruktaki parçanın kazancını, yeni parçanın ilk
+ * buffer'ından hemen önce uygular (streaming thread).
+ */
+static GstPadProbeReturn normalize_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_STREAM_START) {
+        g_mutex_lock(&data->gapless_lock);
+        if (data->queued_index >= 0) {
+            g_object_set(data->normalize_volume, "volume", data->queued_gain, NULL);
+        }
+        g_mutex_unlock(&data->gapless_lock);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+/*
+ * ---- Ekolayzer ----
+ * Beş bantlı parametrik ekolayzer ve tepe sınırlayıcı. playbin'de
+ * audio-filter (audioconvert -> F32 -> normalizasyon volume'u), geçiş
+ * modunda mixer çıkışı üzerinde bir buffer probe'u olarak çalışır; ayrı bir
+ * eleman ya da eklenti gerekmez.
+ *
+ * Bantlar RBJ biquad'larıdır (transposed direct form II) ve art arda
+ * uygulanır. SSE varsa kanallar 4'erli gruplar halinde aynı anda süzülür
+ * (stereo'da tek komutla iki kanal). Ön ayar değişimi yalnızca bir
+ * tamsayıyı atomik olarak yazar; streaming thread sonraki buffer'da
+ * katsayıları yeniler, filtre durumu korunduğu için çalma kesilmez.
+ * "Düz" ön ayarda buffer'a hiç dokunulmaz.
+ *
+ * Sessizlikte ve sönümlerde IIR durumu denormal sayılara iner; x86'da bu
+ * buffer maliyetini onlarca kat artırır. Süzme süresince MXCSR'de
+ * flush-to-zero ve denormals-are-zero açılır, SSE olmayan derlemelerde
+ * çok küçük durumlar her buffer'dan sonra sıfırlanır.
+ */
+
+#define EQ_BANDS           5
+#define EQ_MAX_CHANNELS    8
+#define EQ_LIMIT_CEILING   0.944f // -0.5 dBFS
+#define EQ_LIMIT_RELEASE   0.1    // Sınırlayıcının bırakma süresi (sn)
+#define EQ_DENORMAL_FLOOR  1e-15f // Bunun altındaki durumlar sıfırlanır (SSE yoksa)
+#ifdef __SSE__
+#define EQ_MXCSR_DAZ       0x0040 // Denormals-are-zero (pmmintrin.h'deki _MM_DENORMALS_ZERO_ON)
+#endif
+
+typedef enum {
+    EQ_LOW_SHELF,
+    EQ_PEAK,
+    EQ_HIGH_SHELF
+} EqBandType;
+
+static const struct {
+    EqBandType type;
+    gdouble    frequency; // Hz
+    gdouble    q;
+} eq_bands[EQ_BANDS] = {
+    { EQ_LOW_SHELF,    80.0, 0.707 },
+    { EQ_PEAK,        250.0, 1.0 },
+    { EQ_PEAK,       1000.0, 1.0 },
+    { EQ_PEAK,       4000.0, 1.0 },
+    { EQ_HIGH_SHELF, 10000.0, 0.707 },
+};
+
+/* Ön ayarlar; ilk kayıt (düz) süzgeci tamamen devre dışı bırakır */
+static const struct {
+    const gchar *name;
+    const gchar *label;
+    gdouble      gains[EQ_BANDS]; // dB
+} eq_presets[] = {
+    { "flat",     "Düz",      {  0.0,  0.0,  0.0, 0.0, 0.0 } },
+    { "bass",     "Bas",      {  6.0,  3.0,  0.0, 0.0, 0.0 } },
+    { "vocal",    "Vokal",    { -2.0, -1.0,  2.0, 3.0, 1.0 } },
+    { "treble",   "Tiz",      {  0.0,  0.0,  0.0, 3.0, 6.0 } },
+    { "loudness", "Loudness", {  5.0,  1.0, -1.0, 2.0, 4.0 } },
+};
+
+/* Bir probe'un (pipeline başına bir tane) süzgeç durumu; yalnızca streaming thread'inde kullanılır */
+typedef struct {
+    const gint *preset;    // İstenen ön ayar (PlayerData.eq_preset, atomik okunur)
+    gint        applied;   // Katsayıların hesaplandığı ön ayar (-1: yeniden hesapla)
+    gint        rate;
+    gint        channels;  // 0: desteklenmeyen format, buffer'lar olduğu gibi geçer
+    gfloat      b0[EQ_BANDS], b1[EQ_BANDS], b2[EQ_BANDS], a1[EQ_BANDS], a2[EQ_BANDS];
+    gfloat      z1[EQ_BANDS][EQ_MAX_CHANNELS];
+    gfloat      z2[EQ_BANDS][EQ_MAX_CHANNELS];
+    gfloat      limit_gain;
+    gfloat      limit_release; // Örnek başına bırakma katsayısı
+} Equalizer;
+
+static int equalizer_preset_find(const gchar *name) {
+    for (guint i = 0; i < G_N_ELEMENTS(eq_presets); i++) {
+        if (g_str_equal(eq_presets[i].name, name))
+            return (int)i;
+    }
+    return -1;
+}
+
+static void equalizer_reset(Equalizer *eq) {
+    memset(eq->z1, 0, sizeof(eq->z1));
+    memset(eq->z2, 0, sizeof(eq->z2));
+    eq->limit_gain = 1.0f;
+}
+
+/* Ön ayarın katsayılarını örnekleme hızı için hesaplar (RBJ Audio EQ Cookbook) */
+static void equalizer_configure(Equalizer *eq, gint preset) {
+    for (int b = 0; b < EQ_BANDS; b++) {
+        gdouble frequency = MIN(eq_bands[b].frequency, eq->rate * 0.45);
+        gdouble A = pow(10.0, eq_presets[preset].gains[b] / 40.0);
+        gdouble w0 = 2.0 * G_PI * frequency / eq->rate;
+        gdouble cw = cos(w0), alpha = sin(w0) / (2.0 * eq_bands[b].q);
+        gdouble sa = 2.0 * sqrt(A) * alpha;
+        gdouble b0, b1, b2, a0, a1, a2;
+
+        switch (eq_bands[b].type) {
+        case EQ_LOW_SHELF:
+            b0 = A * ((A + 1) - (A - 1) * cw + sa);
+            b1 = 2 * A * ((A - 1) - (A + 1) * cw);
+            b2 = A * ((A + 1) - (A - 1) * cw - sa);
+            a0 = (A + 1) + (A - 1) * cw + sa;
+            a1 = -2 * ((A - 1) + (A + 1) * cw);
+            a2 = (A + 1) + (A - 1) * cw - sa;
+            break;
+        case EQ_HIGH_SHELF:
+            b0 = A * ((A + 1) + (A - 1) * cw + sa);
+            b1 = -2 * A * ((A - 1) + (A + 1) * cw);
+            b2 = A * ((A + 1) + (A - 1) * cw - sa);
+            a0 = (A + 1) - (A - 1) * cw + sa;
+            a1 = 2 * ((A - 1) - (A + 1) * cw);
+            a2 = (A + 1) - (A - 1) * cw - sa;
+            break;
+        default:
+            b0 = 1 + alpha * A;
+            b1 = -2 * cw;
+            b2 = 1 - alpha * A;
+            a0 = 1 + alpha / A;
+            a1 = -2 * cw;
+            a2 = 1 - alpha / A;
+            break;
+        }
+        eq->b0[b] = (gfloat)(b0 / a0);
+        eq->b1[b] = (gfloat)(b1 / a0);
+        eq->b2[b] = (gfloat)(b2 / a0);
+        eq->a1[b] = (gfloat)(a1 / a0);
+        eq->a2[b] = (gfloat)(a2 / a0);
+    }
+    eq->limit_release = (gfloat)(1.0 - exp(-1.0 / (EQ_LIMIT_RELEASE * eq->rate)));
+    // Düz ayardan çıkarken eski durum kullanılmaz
+    if (eq->applied <= 0)
+        equalizer_reset(eq);
+    eq->applied = preset;
+}
+
+/* Bant zincirini örnek örnek uygular (SSE yoksa ve kıyaslama için) */
+static void equalizer_filter_scalar(Equalizer *eq, gfloat *samples, gsize frames) {
+    int channels = eq->channels;
+
+    for (gsize f = 0; f < frames; f++) {
+        gfloat *frame = samples + f * channels;
+        for (int c = 0; c < channels; c++) {
+            gfloat x = frame[c];
+            for (int b = 0; b < EQ_BANDS; b++) {
+                gfloat y = eq->b0[b] * x + eq->z1[b][c];
+                eq->z1[b][c] = eq->b1[b] * x - eq->a1[b] * y + eq->z2[b][c];
+                eq->z2[b][c] = eq->b2[b] * x - eq->a2[b] * y;
+                x = y;
+            }
+            frame[c] = x;
+        }
+    }
+}
+
+#ifdef __SSE__
+/* Bant zincirini 4 kanala kadar aynı anda uygular; durum buffer boyunca register'larda kalır */
+static void equalizer_filter_sse(Equalizer *eq, gfloat *samples, gsize frames) {
+    int channels = eq->channels;
+
+    for (int c0 = 0; c0 < channels; c0 += 4) {
+        int lanes = MIN(4, channels - c0);
+        __m128 z1[EQ_BANDS], z2[EQ_BANDS];
+
+        for (int b = 0; b < EQ_BANDS; b++) {
+            z1[b] = _mm_loadu_ps(&eq->z1[b][c0]);
+            z2[b] = _mm_loadu_ps(&eq->z2[b][c0]);
+        }
+        for (gsize f = 0; f < frames; f++) {
+            gfloat *frame = samples + f * channels + c0;
+            gfloat lane[4] = { 0 };
+            __m128 x;
+
+            if (lanes == 4) {
+                x = _mm_loadu_ps(frame);
+            } else {
+                memcpy(lane, frame, lanes * sizeof(gfloat));
+                x = _mm_loadu_ps(lane);
+            }
+            for (int b = 0; b < EQ_BANDS; b++) {
+                __m128 y = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(eq->b0[b]), x), z1[b]);
+                z1[b] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(eq->b1[b]), x),
+                                              _mm_mul_ps(_mm_set1_ps(eq->a1[b]), y)), z2[b]);
+                z2[b] = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(eq->b2[b]), x),
+                                   _mm_mul_ps(_mm_set1_ps(eq->a2[b]), y));
+                x = y;
+            }
+            if (lanes == 4) {
+                _mm_storeu_ps(frame, x);
+            } else {
+                _mm_storeu_ps(lane, x);
+                memcpy(frame, lane, lanes * sizeof(gfloat));
+            }
+        }
+        for (int b = 0; b < EQ_BANDS; b++) {
+            _mm_storeu_ps(&eq->z1[b][c0], z1[b]);
+            _mm_storeu_ps(&eq->z2[b][c0], z2[b]);
+        }
+    }
+}
+#endif
+
+/* Anında atak, üstel bırakma: çerçevenin tepesi tavanı geçmez */
+static void equalizer_limit(Equalizer *eq, gfloat *samples, gsize frames) {
+    int channels = eq->channels;
+    gfloat gain = eq->limit_gain;
+
+    for (gsize f = 0; f < frames; f++) {
+        gfloat *frame = samples + f * channels;
+        gfloat peak = 0.0f;
+
+        for (int c = 0; c < channels; c++)
+            peak = MAX(peak, fabsf(frame[c]));
+        gain += (1.0f - gain) * eq->limit_release;
+        if (peak * gain > EQ_LIMIT_CEILING)
+            gain = EQ_LIMIT_CEILING / peak;
+        if (gain < 1.0f) {
+            for (int c = 0; c < channels; c++)
+                frame[c] *= gain;
+        }
+    }
+    eq->limit_gain = gain;
+}
+
+/* Buffer'ı yerinde süzer (streaming thread) */
+static void equalizer_process(Equalizer *eq, gfloat *samples, gsize frames, gboolean simd) {
+    gint preset = g_atomic_int_get(eq->preset);
+
+    if (eq->channels == 0 || preset <= 0 || preset >= (gint)G_N_ELEMENTS(eq_presets)) {
+        eq->applied = 0;
+        return;
+    }
+    if (preset != eq->applied)
+        equalizer_configure(eq, preset);
+
+#ifdef __SSE__
+    // Denormallar sıfır sayılır; streaming thread'in önceki ayarı sonra geri yüklenir
+    unsigned int csr = _mm_getcsr();
+    _mm_setcsr(csr | _MM_FLUSH_ZERO_ON | EQ_MXCSR_DAZ);
+    if (simd)
+        equalizer_filter_sse(eq, samples, frames);
+    else
+        equalizer_filter_scalar(eq, samples, frames);
+    equalizer_limit(eq, samples, frames);
+    _mm_setcsr(csr);
+#else
+    equalizer_filter_scalar(eq, samples, frames);
+    equalizer_limit(eq, samples, frames);
+    for (int b = 0; b < EQ_BANDS; b++) {
+        for (int c = 0; c < eq->channels; c++) {
+            if (fabsf(eq->z1[b][c]) < EQ_DENORMAL_FLOOR)
+                eq->z1[b][c] = 0.0f;
+            if (fabsf(eq->z2[b][c]) < EQ_DENORMAL_FLOOR)
+                eq->z2[b][c] = 0.0f;
+        }
+    }
+#endif
+}
+
+static GstPadProbeReturn equalizer_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    Equalizer *eq = user_data;
+
+    if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+        GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+        if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
+            GstCaps *caps;
+            gst_event_parse_caps(event, &caps);
+            GstStructure *s = gst_caps_get_structure(caps, 0);
+            const gchar *format = gst_structure_get_string(s, "format");
+            gint rate = 0, channels = 0;
+
+            gst_structure_get_int(s, "rate", &rate);
+            gst_structure_get_int(s, "channels", &channels);
+            gboolean supported = format && g_str_equal(format, "F32LE") && rate > 0 &&
+                                 channels > 0 && channels <= EQ_MAX_CHANNELS;
+            eq->rate = rate;
+            eq->channels = supported ? channels : 0;
+            eq->applied = -1;
+        } else if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP) {
+            equalizer_reset(eq);
+        }
+        return GST_PAD_PROBE_OK;
+    }
+
+    if (eq->channels == 0 || g_atomic_int_get(eq->preset) <= 0) {
+        eq->applied = 0;
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstBuffer *buffer = gst_buffer_make_writable(GST_PAD_PROBE_INFO_BUFFER(info));
+    GST_PAD_PROBE_INFO_DATA(info) = buffer;
+
+    GstMapInfo map;
+    if (gst_buffer_map(buffer, &map, GST_MAP_READWRITE)) {
+        equalizer_process(eq, (gfloat *)map.data, map.size / (sizeof(gfloat) * eq->channels), TRUE);
+        gst_buffer_unmap(buffer, &map);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+/* Elemanın çıkışına bir ekolayzer bağlar; durum probe ile birlikte serbest bırakılır */
+static void equalizer_attach(PlayerData *data, GstElement *element) {
+    Equalizer *eq = g_new0(Equalizer, 1);
+    eq->preset = &data->eq_preset;
+    eq->applied = -1;
+    eq->limit_gain = 1.0f;
+
+    GstPad *pad = gst_element_get_static_pad(element, "src");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+                      equalizer_probe_cb, eq, g_free);
+    gst_object_unref(pad);
+}
+
+/* Ekolayzerin çalıştığı F32 (interleaved) biçimini zorlayan capsfilter */
+static GstElement *equalizer_caps_filter(void) {
+    GstElement *filter = gst_element_factory_make("capsfilter", NULL);
+    if (filter) {
+        GstCaps *caps = gst_caps_from_string("audio/x-raw,format=F32LE,layout=interleaved");
+        g_object_set(filter, "caps", caps, NULL);
+        gst_caps_unref(caps);
+    }
+    return filter;
+}
+
+/*
+ * playbin'in audio-filter'ı: audioconvert -> F32 -> tail, ekolayzer tail'in
+ * çıkışında. Gerekli elemanlar yoksa yalnızca tail döner.
+ */
+static GstElement *equalizer_filter_new(PlayerData *data, GstElement *tail) {
+    GstElement *convert = gst_element_factory_make("audioconvert", NULL);
+    GstElement *caps = equalizer_caps_filter();
+
+    if (!convert || !caps) {
+        if (convert)
+            gst_object_unref(convert);
+        if (caps)
+            gst_object_unref(caps);
+        return tail;
+    }
+
+    GstElement *bin = gst_bin_new("audio-filter");
+    gst_bin_add_many(GST_BIN(bin), convert, caps, tail, NULL);
+    gst_element_link_many(convert, caps, tail, NULL);
+
+    GstPad *pad = gst_element_get_static_pad(convert, "sink");
+    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad));
+    gst_object_unref(pad);
+    pad = gst_element_get_static_pad(tail, "src");
+    gst_element_add_pad(bin, gst_ghost_pad_new("src", pad));
+    gst_object_unref(pad);
+
+    equalizer_attach(data, tail);
+    return bin;
+}
+
+/* Ön ayarı değiştirir; çalan pipeline sonraki buffer'dan itibaren uygular */
+static void player_set_equalizer(PlayerData *data, int preset) {
+    if (preset >= 0 && preset < (int)G_N_ELEMENTS(eq_presets))
+        g_atomic_int_set(&data->eq_preset, preset);
+}
+
+static void on_equalizer_changed(GtkComboBox *combo, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    const gchar *id = gtk_combo_box_get_active_id(combo);
+
+    if (id)
+        player_set_equalizer(data, equalizer_preset_find(id));
+}
+
+/* Havuzdaki işçi: değişmişse tek bir dosyayı ölçer */
+static void loudness_worker(gpointer task, gpointer user_data) {
+    LoudnessAnalysis *analysis = user_data;
+    PlayerData *data = analysis->data;
+    gchar *path = task;
+    GStatBuf st;
+
+    if (g_stat(path, &st) == 0) {
+        gboolean cached;
+
+        g_mutex_lock(&data->loudness_lock);
+        LoudnessEntry *entry = g_hash_table_lookup(data->loudness_index, path);
+        cached = entry && entry->mtime == st.st_mtime && entry->size == st.st_size;
+        g_mutex_unlock(&data->loudness_lock);
+
+        if (cached) {
+            g_atomic_int_inc(&analysis->hits);
+        } else {
+            LoudnessEntry *result = g_new0(LoudnessEntry, 1);
+            result->path = path;
+            result->mtime = st.st_mtime;
+            result->size = st.st_size;
+            path = NULL;
+
+            if (loudness_measure(result)) {
+                g_mutex_lock(&analysis->lock);
+                g_ptr_array_add(analysis->pending, result);
+                g_mutex_unlock(&analysis->lock);
+            } else {
+                loudness_entry_free(result);
+            }
+            g_atomic_int_inc(&analysis->misses);
+        }
+    }
+
+    g_free(path);
+    g_atomic_int_inc(&analysis->finished);
+}
+
+/* Ölçümleri ana thread'de önbelleğe taşır; analiz bitince önbelleği diske yazar */
+static gboolean loudness_analysis_flush(gpointer user_data) {
+    LoudnessAnalysis *analysis = user_data;
+    PlayerData *data = analysis->data;
+
+    g_mutex_lock(&analysis->lock);
+    GPtrArray *batch = analysis->pending;
+    analysis->pending = g_ptr_array_new();
+    g_mutex_unlock(&analysis->lock);
+
+    if (batch->len > 0) {
+        g_mutex_lock(&data->loudness_lock);
+        for (guint i = 0; i < batch->len; i++) {
+            LoudnessEntry *entry = g_ptr_array_index(batch, i);
+            g_hash_table_replace(data->loudness_index, entry->path, entry);
+        }
+        g_mutex_unlock(&data->loudness_lock);
+
+        // Çalan ya da sıradaki parça ölçülmüş olabilir
+        player_apply_gain(data);
+    }
+    g_ptr_array_free(batch, TRUE);
+
+    if (g_atomic_int_get(&analysis->finished) < analysis->total)
+        return G_SOURCE_CONTINUE;
+
+    g_thread_pool_free(analysis->pool, FALSE, TRUE);
+    loudness_index_save(data->loudness_index);
+    g_print("Ses analizi bitti: %d dosya (%d önbellekten, %d ölçüldü) %.2f sn\n",
+            analysis->total, analysis->hits, analysis->misses,
+            (g_get_monotonic_time() - analysis->start_time) / (gdouble)G_USEC_PER_SEC);
+
+    g_ptr_array_free(analysis->pending, TRUE);
+    g_mutex_clear(&analysis->lock);
+    g_free(analysis);
+    data->loudness_analysis = NULL;
+    return G_SOURCE_REMOVE;
+}
+
+/* Playlistteki tüm parçaların ses yüksekliğini arkaplanda, tüm çekirdeklerde ölçer */
+static void loudness_analysis_start(PlayerData *data) {
+    int count = playlist_store_count(data->playlist);
+
+    if (data->loudness_analysis) {
+        g_print("Bir ses analizi zaten sürüyor.\n");
+        return;
+    }
+    if (count == 0)
+        return;
+
+    LoudnessAnalysis *analysis = g_new0(LoudnessAnalysis, 1);
+    analysis->data = data;
+    analysis->pending = g_ptr_array_new();
+    analysis->total = count;
+    analysis->start_time = g_get_monotonic_time();
+    g_mutex_init(&analysis->lock);
+    analysis->pool = g_thread_pool_new(loudness_worker, analysis, (gint)g_get_num_processors(), FALSE, NULL);
+    data->loudness_analysis = analysis;
+
+    // İşçiler arenaya erişmez: playlist bu sırada değişebilir
+    for (int i = 0; i < count; i++) {
+        g_thread_pool_push(analysis->pool, g_strdup(playlist_store_path(data->playlist, i)), NULL);
+    }
+    g_timeout_add(LIBRARY_FLUSH_INTERVAL, loudness_analysis_flush, analysis);
+}
+
+static void on_analyze_clicked(GtkWidget *button, gpointer user_data) {
+    loudness_analysis_start((PlayerData *)user_data);
+}
+
+/* Normalizasyon toggle butonu tıklandığında çağrılır */
+static void on_normalize_toggled(GtkToggleButton *toggle, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    data->normalize_enabled = gtk_toggle_button_get_active(toggle);
+    player_apply_gain(data);
+}
+
+/*
+ * ---- Kopya parça tespiti ----
+ * Aynı şarkının farklı adlı ya da farklı bit hızlı kopyaları akustik parmak
+ * iziyle bulunur. Ses yüksekliği analizindeki gibi her dosya çekirdek
+ * sayısı kadar işçisi olan bir GThreadPool'da çözülür: baştaki sessizlik
+ * atlanır, örnekler tek kanala indirilip seyreltilir ve 300-2000 Hz
+ * arasındaki 33 bant süzgecinin çerçeve enerjilerinden Haitsma-Kalker
+ * yöntemiyle çerçeve başına 32 bit üretilir. FINGERPRINT_FRAMES çerçeve
+ * (~48 sn) toplanınca çözme bitirilir.
+ *
+ * Parmak izleri mtime/boyut ile diskteki önbellekte saklanır. Kümeleme
+ * bit örneklemeli LSH ile yapılır: her tabloda parmak izinin sabit
+ * FINGERPRINT_LSH_BITS bitinden bir anahtar çıkar ve yalnızca aynı
+ * anahtarı paylaşan parçaların bit hata oranı hesaplanır. Böylece büyük
+ * kütüphanelerde bile tüm çiftler karşılaştırılmaz. Bit hata oranı p olan
+ * bir çift en az bir tabloda 1 - (1 - (1-p)^BITS)^TABLES olasılıkla
+ * buluşur; anahtar kısa tutulduğu için eşiğe yakın kopyalar da kaçmaz.
+ */
+
+#define FINGERPRINT_MAGIC      "MPFP"
+#define FINGERPRINT_VERSION    1
+#define FINGERPRINT_BANDS      33      // Çerçeve başına 32 bit (komşu bant farkları)
+#define FINGERPRINT_FRAMES     128     // Parmak izindeki 32 bitlik kelime sayısı
+#define FINGERPRINT_MIN_FRAMES 32      // Daha kısa parmak izleri karşılaştırılmaz
+#define FINGERPRINT_RATE       11025   // Seyreltme hedefi (Hz)
+#define FINGERPRINT_FRAME      0.372   // Çerçeve süresi (sn)
+#define FINGERPRINT_SILENCE    1e-6    // Baştaki sessizliğin örnek enerjisi eşiği
+#define FINGERPRINT_MAX_BER    0.15    // Kopya sayılacak en yüksek bit hata oranı
+#define FINGERPRINT_MAX_DRIFT  3000    // Kopyaların süre farkı üst sınırı (ms)
+#define FINGERPRINT_LSH_TABLES 24
+#define FINGERPRINT_LSH_BITS   13      // Eşikteki (BER 0.15) çiftin bir kovada buluşma olasılığı ~%95
+#define FINGERPRINT_LSH_WINDOW 64      // Aynı kovada bir parçanın karşılaştırıldığı komşu sayısı
+
+/* Önbellekteki bir dosyanın parmak izi */
+typedef struct {
+    gchar   *path;
+    gint64   mtime;
+    gint64   size;
+    gint64   duration;                   // ms (bilinmiyorsa -1)
+    guint32  frames;                     // Geçerli kelime sayısı (0: çözülemedi ya da çok kısa)
+    guint32  words[FINGERPRINT_FRAMES];
+} FingerprintEntry;
+
+/* Diskteki önbelleğin başlığı; ardından kayıtlar gelir */
+typedef struct {
+    gchar   magic[4];
+    guint32 version;
+    guint32 count;
+    guint32 reserved;
+} FingerprintHeader;
+
+/* Önbellek kaydı; ardından path_length baytlık yol gelir */
+typedef struct {
+    gint64  mtime;
+    gint64  size;
+    gint64  duration;
+    guint32 frames;
+    guint32 path_length;
+    guint32 words[FINGERPRINT_FRAMES];
+} FingerprintRecord;
+
+struct _DuplicateAnalysis {
+    PlayerData  *data;
+    GThreadPool *pool;
+    GPtrArray   *paths;    // Playlist sırasıyla tekil yollar (kümelemede kullanılır)
+
+    GMutex       lock;     // pending'i korur
+    GPtrArray   *pending;  // Ana thread'e aktarılmayı bekleyen FingerprintEntry'ler
+    gint         total;
+    gint         finished; // Biten iş sayısı (atomik)
+    gint         hits;     // Önbellekten gelen dosya sayısı (atomik)
+    gint         misses;   // Çözülen dosya sayısı (atomik)
+    gint64       start_time;
+};
+
+/* Tek bir dosyanın parmak izi durumu; fakesink handoff'unda (streaming thread) güncellenir */
+typedef struct {
+    gint     rate;
+    gint     channels;
+    gint     decimation;  // Bir örneğe indirilen (tek kanallı) örnek sayısı
+    gint     frame_size;  // Çerçeve başına seyreltilmiş örnek
+    Biquad   bands[FINGERPRINT_BANDS];
+    gdouble  state[FINGERPRINT_BANDS][2];
+    gdouble  energy[FINGERPRINT_BANDS];
+    gdouble  previous[FINGERPRINT_BANDS];
+    gdouble  sum;         // Seyreltme toplamı
+    gint     sum_fill;
+    gint     frame_fill;
+    gboolean started;     // Baştaki sessizlik geçildi
+    gboolean have_previous;
+    gboolean done;        // Yeterli çerçeve toplandı, çözme bitiriliyor
+    guint64  samples;     // Çözülen çerçeve sayısı (süre için)
+    gint64   duration;    // Sorgulanan süre (ns, bilinmiyorsa -1)
+    FingerprintEntry *entry;
+} FingerprintBuilder;
+
+/* Bant süzgeçlerini (sabit Q, logaritmik aralıklı) seyreltilmiş hız için hesaplar */
+static void fingerprint_builder_init(FingerprintBuilder *builder, gint rate, gint channels) {
+    builder->rate = rate;
+    builder->channels = channels;
+    builder->decimation = MAX(1, rate / FINGERPRINT_RATE);
+
+    gdouble low_rate = (gdouble)rate / builder->decimation;
+    gdouble ratio = pow(2000.0 / 300.0, 1.0 / FINGERPRINT_BANDS);
+    gdouble q = sqrt(ratio) / (ratio - 1.0);
+
+    builder->frame_size = MAX(1, (gint)(FINGERPRINT_FRAME * low_rate));
+    for (int b = 0; b < FINGERPRINT_BANDS; b++) {
+        gdouble center = 300.0 * pow(ratio, b + 0.5);
+        gdouble w0 = 2.0 * G_PI * center / low_rate;
+        gdouble alpha = sin(w0) / (2.0 * q);
+        gdouble a0 = 1.0 + alpha;
+
+        builder->bands[b].b0 = alpha / a0;
+        builder->bands[b].b1 = 0.0;
+        builder->bands[b].b2 = -alpha / a0;
+        builder->bands[b].a1 = -2.0 * cos(w0) / a0;
+        builder->bands[b].a2 = (1.0 - alpha) / a0;
+    }
+}
+
+/* Çerçeve bitti: komşu bant farklarının zamandaki değişiminin işaretleri bir kelime olur */
+static void fingerprint_builder_frame(FingerprintBuilder *builder) {
+    if (builder->have_previous) {
+        guint32 word = 0;
+        for (int b = 0; b < FINGERPRINT_BANDS - 1; b++) {
+            gdouble delta = (builder->energy[b] - builder->energy[b + 1]) -
+                            (builder->previous[b] - builder->previous[b + 1]);
+            if (delta > 0.0)
+                word |= 1u << b;
+        }
+        builder->entry->words[builder->entry->frames++] = word;
+    }
+    memcpy(builder->previous, builder->energy, sizeof(builder->energy));
+    memset(builder->energy, 0, sizeof(builder->energy));
+    builder->have_previous = TRUE;
+    builder->frame_fill = 0;
+}
+
+static void fingerprint_builder_process(FingerprintBuilder *builder, const gfloat *samples, gsize frames) {
+    for (gsize i = 0; i < frames && builder->entry->frames < FINGERPRINT_FRAMES; i++) {
+        for (gint c = 0; c < builder->channels; c++)
+            builder->sum += samples[i * builder->channels + c];
+        if (++builder->sum_fill < builder->decimation)
+            continue;
+
+        gdouble x = builder->sum / (builder->decimation * builder->channels);
+        builder->sum = 0.0;
+        builder->sum_fill = 0;
+
+        // Kopyalar arasında farklı olabilen baştaki sessizlik atlanır
+        if (!builder->started) {
+            if (x * x < FINGERPRINT_SILENCE)
+                continue;
+            builder->started = TRUE;
+        }
+        for (int b = 0; b < FINGERPRINT_BANDS; b++) {
+            gdouble y = biquad_process(&builder->bands[b], builder->state[b], x);
+            builder->energy[b] += y * y;
+        }
+        if (++builder->frame_fill == builder->frame_size)
+            fingerprint_builder_frame(builder);
+    }
+}
+
+static void fingerprint_handoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer user_data) {
+    FingerprintBuilder *builder = user_data;
+    GstMapInfo map;
+
+    if (builder->done)
+        return;
+
+    if (builder->rate == 0) {
+        GstCaps *caps = gst_pad_get_current_caps(pad);
+        gint rate = 0, channels = 0;
+
+        if (caps) {
+            GstStructure *s = gst_caps_get_structure(caps, 0);
+            gst_structure_get_int(s, "rate", &rate);
+            gst_structure_get_int(s, "channels", &channels);
+            gst_caps_unref(caps);
+        }
+        if (rate <= 0 || channels <= 0)
+            return;
+        fingerprint_builder_init(builder, rate, channels);
+    }
+
+    if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        gsize frames = map.size / (sizeof(gfloat) * builder->channels);
+        fingerprint_builder_process(builder, (const gfloat *)map.data, frames);
+        builder->samples += frames;
+        gst_buffer_unmap(buffer, &map);
+    }
+
+    // Parmak izi doldu: dosyanın geri kalanı çözülmez
+    if (builder->entry->frames == FINGERPRINT_FRAMES) {
+        builder->done = TRUE;
+        if (!gst_element_query_duration(sink, GST_FORMAT_TIME, &builder->duration))
+            builder->duration = -1;
+        gst_element_post_message(sink, gst_message_new_eos(GST_OBJECT(sink)));
+    }
+}
+
+/* Dosyanın parmak izini çıkarır (işçi thread); kullanılamıyorsa entry->frames 0 kalır */
+static void fingerprint_compute(FingerprintEntry *entry) {
+    FingerprintBuilder builder = { 0 };
+    builder.entry = entry;
+    builder.duration = -1;
+    entry->duration = -1;
+
+    if (!decode_file_f32(entry->path, G_CALLBACK(fingerprint_handoff), &builder) || builder.rate == 0) {
+        entry->frames = 0;
+        return;
+    }
+    if (builder.done) {
+        if (builder.duration >= 0)
+            entry->duration = builder.duration / GST_MSECOND;
+    } else {
+        entry->duration = (gint64)(builder.samples * 1000 / builder.rate);
+    }
+    if (entry->frames < FINGERPRINT_MIN_FRAMES)
+        entry->frames = 0;
+    // Kısa parmak izlerinin kalanı LSH için sıfırdır
+    memset(entry->words + entry->frames, 0, (FINGERPRINT_FRAMES - entry->frames) * sizeof(guint32));
+}
+
+/* İki parmak izinin ortak çerçevelerindeki bit hata oranı */
+static gdouble fingerprint_distance(const FingerprintEntry *a, const FingerprintEntry *b) {
+    guint frames = MIN(a->frames, b->frames);
+    guint errors = 0;
+
+    for (guint i = 0; i < frames; i++)
+        errors += __builtin_popcount(a->words[i] ^ b->words[i]);
+    return frames > 0 ? (gdouble)errors / (frames * 32) : 1.0;
+}
+
+static gboolean fingerprint_match(const FingerprintEntry *a, const FingerprintEntry *b) {
+    if (a->duration >= 0 && b->duration >= 0 && ABS(a->duration - b->duration) > FINGERPRINT_MAX_DRIFT)
+        return FALSE;
+    return fingerprint_distance(a, b) <= FINGERPRINT_MAX_BER;
+}
+
+/* LSH tablolarının örneklediği bit konumları; her çalıştırmada aynıdır */
+static guint16 fingerprint_lsh_bits[FINGERPRINT_LSH_TABLES][FINGERPRINT_LSH_BITS];
+
+static gpointer fingerprint_lsh_init(gpointer unused) {
+    GRand *rand = g_rand_new_with_seed(0x4d504650);
+    for (int t = 0; t < FINGERPRINT_LSH_TABLES; t++) {
+        for (int k = 0; k < FINGERPRINT_LSH_BITS; k++)
+            fingerprint_lsh_bits[t][k] = (guint16)g_rand_int_range(rand, 0, FINGERPRINT_FRAMES * 32);
+    }
+    g_rand_free(rand);
+    return NULL;
+}
+
+static guint32 fingerprint_lsh_key(const FingerprintEntry *entry, int table) {
+    guint32 key = 0;
+    for (int k = 0; k < FINGERPRINT_LSH_BITS; k++) {
+        guint bit = fingerprint_lsh_bits[table][k];
+        key = (key << 1) | ((entry->words[bit / 32] >> (bit % 32)) & 1);
+    }
+    return key;
+}
+
+static guint fingerprint_find(guint *parent, guint i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static gint fingerprint_compare_keys(gconstpointer a, gconstpointer b) {
+    guint64 x = *(const guint64 *)a, y = *(const guint64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * Parmak izlerini kümeler. Dönen dizide her kaydın kümesinin kökü (kümedeki
+ * en küçük indeks) bulunur; kopyası olmayan kayıt kendisini gösterir.
+ */
+static guint *fingerprint_cluster(FingerprintEntry **entries, guint n) {
+    static GOnce lsh_once = G_ONCE_INIT;
+    g_once(&lsh_once, fingerprint_lsh_init, NULL);
+
+    guint *parent = g_new(guint, MAX(n, 1));
+    guint64 *keys = g_new(guint64, MAX(n, 1));
+
+    for (guint i = 0; i < n; i++)
+        parent[i] = i;
+
+    for (int t = 0; t < FINGERPRINT_LSH_TABLES; t++) {
+        // (anahtar, indeks) çiftleri sıralanınca aynı kovadakiler yan yana gelir
+        guint count = 0;
+        for (guint i = 0; i < n; i++) {
+            if (entries[i]->frames > 0)
+                keys[count++] = ((guint64)fingerprint_lsh_key(entries[i], t) << 32) | i;
+        }
+        qsort(keys, count, sizeof(guint64), fingerprint_compare_keys);
+
+        for (guint i = 0; i < count; i++) {
+            guint a = (guint)keys[i];
+            for (guint j = i + 1; j < count && j <= i + FINGERPRINT_LSH_WINDOW &&
+                                  (keys[j] >> 32) == (keys[i] >> 32); j++) {
+                guint b = (guint)keys[j];
+                guint ra = fingerprint_find(parent, a), rb = fingerprint_find(parent, b);
+                if (ra != rb && fingerprint_match(entries[a], entries[b])) {
+                    // Kök hep kümedeki en küçük indekstir
+                    parent[MAX(ra, rb)] = MIN(ra, rb);
+                }
+            }
+        }
+    }
+
+    for (guint i = 0; i < n; i++)
+        parent[i] = fingerprint_find(parent, i);
+    g_free(keys);
+    return parent;
+}
+
+static void fingerprint_entry_free(gpointer p) {
+    FingerprintEntry *entry = p;
+    g_free(entry->path);
+    g_free(entry);
+}
+
+static gchar *fingerprint_index_path(void) {
+    return g_build_filename(g_get_user_cache_dir(), "mp3_player", "fingerprints.idx", NULL);
+}
+
+static GHashTable *fingerprint_index_load(void) {
+    GHashTable *index = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, fingerprint_entry_free);
+    gchar *path = fingerprint_index_path();
+    GMappedFile *file = g_mapped_file_new(path, FALSE, NULL);
+    g_free(path);
+    if (!file)
+        return index;
+
+    const gchar *contents = g_mapped_file_get_contents(file);
+    gsize length = g_mapped_file_get_length(file);
+    FingerprintHeader header;
+
+    if (length >= sizeof(header)) {
+        memcpy(&header, contents, sizeof(header));
+        if (memcmp(header.magic, FINGERPRINT_MAGIC, 4) == 0 && header.version == FINGERPRINT_VERSION) {
+            gsize offset = sizeof(header);
+            for (guint32 i = 0; i < header.count && offset + sizeof(FingerprintRecord) <= length; i++) {
+                FingerprintRecord record;
+                memcpy(&record, contents + offset, sizeof(record));
+                offset += sizeof(record);
+                if (record.path_length > length - offset || record.frames > FINGERPRINT_FRAMES)
+                    break;
+
+                FingerprintEntry *entry = g_new(FingerprintEntry, 1);
+                entry->path = g_strndup(contents + offset, record.path_length);
+                entry->mtime = record.mtime;
+                entry->size = record.size;
+                entry->duration = record.duration;
+                entry->frames = record.frames;
+                memcpy(entry->words, record.words, sizeof(entry->words));
+                g_hash_table_replace(index, entry->path, entry);
+                offset += record.path_length;
+            }
+        }
+    }
+    g_mapped_file_unref(file);
+    return index;
+}
+
+static void fingerprint_index_save(GHashTable *index) {
+    GString *out = g_string_sized_new(sizeof(FingerprintHeader) +
+                                      g_hash_table_size(index) * (sizeof(FingerprintRecord) + 64));
+    FingerprintHeader header = { .version = FINGERPRINT_VERSION, .count = g_hash_table_size(index) };
+    GHashTableIter iter;
+    gpointer value;
+
+    memcpy(header.magic, FINGERPRINT_MAGIC, 4);
+    g_string_append_len(out, (const gchar *)&header, sizeof(header));
+    g_hash_table_iter_init(&iter, index);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        FingerprintEntry *entry = value;
+        FingerprintRecord record = {
+            .mtime = entry->mtime,
+            .size = entry->size,
+            .duration = entry->duration,
+            .frames = entry->frames,
+            .path_length = (guint32)strlen(entry->path),
+        };
+        memcpy(record.words, entry->words, sizeof(record.words));
+        g_string_append_len(out, (const gchar *)&record, sizeof(record));
+        g_string_append_len(out, entry->path, record.path_length);
+    }
+
+    gchar *path = fingerprint_index_path();
+    gchar *dir = g_path_get_dirname(path);
+    GError *err = NULL;
+
+    g_mkdir_with_parents(dir, 0755);
+    if (!g_file_set_contents(path, out->str, out->len, &err)) {
+        g_printerr("Hata: Parmak izi önbelleği yazılamadı: %s\n", err->message);
+        g_error_free(err);
+    }
+
+    g_free(dir);
+    g_free(path);
+    g_string_free(out, TRUE);
+}
+
+/* Havuzdaki işçi: değişmişse tek bir dosyanın parmak izini çıkarır */
+static void duplicate_worker(gpointer task, gpointer user_data) {
+    DuplicateAnalysis *analysis = user_data;
+    PlayerData *data = analysis->data;
+    gchar *path = task;
+    GStatBuf st;
+
+    if (g_stat(path, &st) == 0) {
+        gboolean cached;
+
+        g_mutex_lock(&data->fingerprint_lock);
+        FingerprintEntry *entry = g_hash_table_lookup(data->fingerprint_index, path);
+        cached = entry && entry->mtime == st.st_mtime && entry->size == st.st_size;
+        g_mutex_unlock(&data->fingerprint_lock);
+
+        if (cached) {
+            g_atomic_int_inc(&analysis->hits);
+        } else {
+            FingerprintEntry *result = g_new0(FingerprintEntry, 1);
+            result->path = path;
+            result->mtime = st.st_mtime;
+            result->size = st.st_size;
+            path = NULL;
+
+            // Çözülemeyen dosya da önbelleğe girer; değişmedikçe yeniden denenmez
+            fingerprint_compute(result);
+            g_mutex_lock(&analysis->lock);
+            g_ptr_array_add(analysis->pending, result);
+            g_mutex_unlock(&analysis->lock);
+            g_atomic_int_inc(&analysis->misses);
+        }
+    }
+
+    g_free(path);
+    g_atomic_int_inc(&analysis->finished);
+}
+
+/* Analizdeki yolları kümeler; sonucu data->duplicates'e (yol -> kümenin ilk yolu) yazar */
+static guint duplicates_build(PlayerData *data, GPtrArray *paths, guint *groups) {
+    FingerprintEntry **entries = g_new(FingerprintEntry *, MAX(paths->len, 1));
+    guint n = 0, duplicates = 0;
+
+    for (guint i = 0; i < paths->len; i++) {
+        FingerprintEntry *entry = g_hash_table_lookup(data->fingerprint_index, g_ptr_array_index(paths, i));
+        if (entry && entry->frames > 0)
+            entries[n++] = entry;
+    }
+    guint *root = fingerprint_cluster(entries, n);
+
+    if (data->duplicates)
+        g_hash_table_unref(data->duplicates);
+    data->duplicates = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    *groups = 0;
+    for (guint i = 0; i < n; i++) {
+        if (root[i] == i)
+            continue;
+        if (!g_hash_table_contains(data->duplicates, entries[root[i]]->path)) {
+            g_hash_table_insert(data->duplicates, g_strdup(entries[root[i]]->path),
+                                g_strdup(entries[root[i]]->path));
+            (*groups)++;
+        }
+        g_hash_table_insert(data->duplicates, g_strdup(entries[i]->path), g_strdup(entries[root[i]]->path));
+        duplicates++;
+    }
+
+    g_free(root);
+    g_free(entries);
+    return duplicates;
+}
+
+/* Kopya gruplamasında konumdaki parçanın anahtarı (grubun ilk yolu ya da kendi yolu) */
+static const gchar *duplicates_key(PlayerData *data, int position) {
+    const gchar *path = playlist_store_path(data->playlist, position);
+    const gchar *key = data->duplicates ? g_hash_table_lookup(data->duplicates, path) : NULL;
+    return key ? key : path;
+}
+
+/*
+ * Aynı parçanın (aynı yol ya da bulunan kopya) yalnızca bir kopyasını
+ * bırakır: çalan parçanın grubunda çalan parça, diğerlerinde ilk geçtiği
+ * yer. Çalan parça hiç çıkarılmadığı için çalma etkilenmez. Çıkarılan
+ * sayıyı döndürür.
+ */
+static int duplicates_collapse(PlayerData *data) {
+    int count = playlist_store_count(data->playlist);
+    gboolean has_current = data->current_index >= 0 && data->current_index < count;
+    GHashTable *keep = g_hash_table_new(g_str_hash, g_str_equal); // Anahtar -> bırakılan konum
+    gboolean *remove = g_new0(gboolean, MAX(count, 1));
+    int removed = 0, removed_before_current = 0;
+
+    if (has_current)
+        g_hash_table_insert(keep, (gpointer)duplicates_key(data, data->current_index),
+                            GINT_TO_POINTER(data->current_index));
+    for (int i = 0; i < count; i++) {
+        const gchar *key = duplicates_key(data, i);
+        if (!g_hash_table_contains(keep, key))
+            g_hash_table_insert(keep, (gpointer)key, GINT_TO_POINTER(i));
+    }
+    for (int i = 0; i < count; i++) {
+        if (GPOINTER_TO_INT(g_hash_table_lookup(keep, duplicates_key(data, i))) != i) {
+            remove[i] = TRUE;
+            removed++;
+            if (has_current && i < data->current_index)
+                removed_before_current++;
+        }
+    }
+
+    if (removed > 0) {
+        if (has_current)
+            data->current_index -= removed_before_current;
+        playlist_store_remove_marked(data->playlist, remove);
+        refresh_playlist(data);
+        update_labels_and_buttons(data);
+    }
+
+    g_hash_table_unref(keep);
+    g_free(remove);
+    return removed;
+}
+
+/* Kopya sorusunun yanıtı */
+static void on_duplicates_response(GtkDialog *dialog, gint response, gpointer user_data) {
+    if (response == GTK_RESPONSE_YES)
+        duplicates_collapse((PlayerData *)user_data);
+    gtk_widget_destroy(GTK_WIDGET(dialog));
+}
+
+/* Parmak izlerini ana thread'de önbelleğe taşır; analiz bitince kümeler ve sonucu bildirir */
+static gboolean duplicate_analysis_flush(gpointer user_data) {
+    DuplicateAnalysis *analysis = user_data;
+    PlayerData *data = analysis->data;
+
+    g_mutex_lock(&analysis->lock);
+    GPtrArray *batch = analysis->pending;
+    analysis->pending = g_ptr_array_new();
+    g_mutex_unlock(&analysis->lock);
+
+    if (batch->len > 0) {
+        g_mutex_lock(&data->fingerprint_lock);
+        for (guint i = 0; i < batch->len; i++) {
+            FingerprintEntry *entry = g_ptr_array_index(batch, i);
+            g_hash_table_replace(data->fingerprint_index, entry->path, entry);
+        }
+        g_mutex_unlock(&data->fingerprint_lock);
+    }
+    g_ptr_array_free(batch, TRUE);
+
+    if (g_atomic_int_get(&analysis->finished) < analysis->total)
+        return G_SOURCE_CONTINUE;
+
+    g_thread_pool_free(analysis->pool, FALSE, TRUE);
+    if (analysis->misses > 0)
+        fingerprint_index_save(data->fingerprint_index);
+
+    gint64 cluster_start = g_get_monotonic_time();
+    guint groups;
+    guint duplicates = duplicates_build(data, analysis->paths, &groups);
+    g_print("Kopya analizi bitti: %d dosya (%d önbellekten, %d çözüldü) %.2f sn, "
+            "kümeleme %.1f ms; %u grupta %u kopya\n",
+            analysis->total, analysis->hits, analysis->misses,
+            (g_get_monotonic_time() - analysis->start_time) / (gdouble)G_USEC_PER_SEC,
+            (g_get_monotonic_time() - cluster_start) / 1000.0, groups, duplicates);
+
+    g_ptr_array_free(analysis->paths, TRUE);
+    g_ptr_array_free(analysis->pending, TRUE);
+    g_mutex_clear(&analysis->lock);
+    g_free(analysis);
+    data->duplicate_analysis = NULL;
+
+    // Arayüzde kopyaları listeden çıkarmayı öner
+    if (data->window && duplicates > 0) {
+        GtkWidget *dialog = gtk_message_dialog_new(GTK_WINDOW(data->window),
+                                                   GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+                                                   GTK_MESSAGE_QUESTION, GTK_BUTTONS_YES_NO,
+                                                   "%u parça, listedeki başka bir parçanın kopyası (%u grup).",
+                                                   duplicates, groups);
+        gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(dialog),
+                                                 "Her gruptan yalnızca ilk parça (çalan parça varsa o) "
+                                                 "bırakılsın mı?");
+        // Yanıt sinyalle gelir; bu callback'te iç içe ana döngü açılmaz
+        g_signal_connect(dialog, "response", G_CALLBACK(on_duplicates_response), data);
+        gtk_widget_show(dialog);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+/* Playlistteki parçaların parmak izlerini arkaplanda, tüm çekirdeklerde çıkarır ve kopyaları bulur */
+static void duplicate_analysis_start(PlayerData *data) {
+    int count = playlist_store_count(data->playlist);
+
+    if (data->duplicate_analysis) {
+        g_print("Bir kopya analizi zaten sürüyor.\n");
+        return;
+    }
+    if (count == 0)
+        return;
+
+    // Önbellek ilk analizde yüklenir
+    if (!data->fingerprint_index)
+        data->fingerprint_index = fingerprint_index_load();
+
+    DuplicateAnalysis *analysis = g_new0(DuplicateAnalysis, 1);
+    analysis->data = data;
+    analysis->pending = g_ptr_array_new();
+    analysis->paths = g_ptr_array_new_with_free_func(g_free);
+    analysis->start_time = g_get_monotonic_time();
+    g_mutex_init(&analysis->lock);
+
+    // Aynı yol bir kez çözülür; işçiler arenaya erişmez
+    GHashTable *unique = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int i = 0; i < count; i++) {
+        const gchar *path = playlist_store_path(data->playlist, i);
+        if (g_hash_table_add(unique, (gpointer)path))
+            g_ptr_array_add(analysis->paths, g_strdup(path));
+    }
+    g_hash_table_unref(unique);
+
+    analysis->total = (gint)analysis->paths->len;
+    analysis->pool = g_thread_pool_new(duplicate_worker, analysis, (gint)g_get_num_processors(), FALSE, NULL);
+    data->duplicate_analysis = analysis;
+    for (guint i = 0; i < analysis->paths->len; i++) {
+        g_thread_pool_push(analysis->pool, g_strdup(g_ptr_array_index(analysis->paths, i)), NULL);
+    }
+    g_timeout_add(LIBRARY_FLUSH_INTERVAL, duplicate_analysis_flush, analysis);
+}
+
+static void on_duplicates_clicked(GtkWidget *button, gpointer user_data) {
+    duplicate_analysis_start((PlayerData *)user_data);
+}
+
+/*
+ * ---- Dalga formu özeti ----
+ * Çalan parçanın min/max tepe özeti slider'ın arkasına çizilir. Özet,
+ * arkaplandaki tek bir işçi thread'inde (decode_file_f32 ile, saat
+ * beklemeden) dosya başına bir kez hesaplanır ve WAVEFORM_BINS çift
+ * gint8 olarak diske yazılır. Çizim, boyut değişene kadar saklanan bir
+ * cairo yüzeyinin kopyalanmasından ibarettir.
+ */
+
+#define WAVEFORM_BINS    1024   // Özetteki (min, max) çifti sayısı
+#define WAVEFORM_MAGIC   "MPWF"
+#define WAVEFORM_VERSION 1
+
+/* Diskteki özet dosyasının başlığı; ardından WAVEFORM_BINS x (min, max) gint8 gelir */
+typedef struct {
+    gchar   magic[4];
+    guint32 version;
+    gint64  mtime;
+    gint64  size;
+} WaveformHeader;
+
+/* Bir dosyanın özet işi; işçi thread doldurur, ana thread teslim alır */
+typedef struct {
+    PlayerData *data;
+    gchar      *path;
+    gint        generation; // İstek anındaki data->waveform_generation
+    gint8      *peaks;      // Sonuç (başarısızsa NULL)
+} WaveformJob;
+
+/* Çözümleme sırasında biriken ara tepeler (10 ms'lik dilimler) */
+typedef struct {
+    gint    rate;
+    gint    channels;
+    gsize   slice_size; // Dilim başına örnek (tüm kanallar)
+    gsize   slice_fill;
+    gfloat  min, max;
+    GArray *slices;     // gfloat çiftleri: (min, max)
+} WaveformBuilder;
+
+/* samples içindeki en küçük ve en büyük değeri min ve max'e katar (SSE varsa 4'er 4'er) */
+static void peaks_minmax(const gfloat *samples, gsize n, gfloat *min, gfloat *max) {
+    gsize i = 0;
+    gfloat lo = *min, hi = *max;
+
+#ifdef __SSE__
+    if (n >= 8) {
+        __m128 vmin = _mm_set1_ps(lo);
+        __m128 vmax = _mm_set1_ps(hi);
+        for (; i + 8 <= n; i += 8) {
+            __m128 a = _mm_loadu_ps(samples + i);
+            __m128 b = _mm_loadu_ps(samples + i + 4);
+            vmin = _mm_min_ps(vmin, _mm_min_ps(a, b));
+            vmax = _mm_max_ps(vmax, _mm_max_ps(a, b));
+        }
+        gfloat lanes_min[4], lanes_max[4];
+        _mm_storeu_ps(lanes_min, vmin);
+        _mm_storeu_ps(lanes_max, vmax);
+        for (int k = 0; k < 4; k++) {
+            lo = MIN(lo, lanes_min[k]);
+            hi = MAX(hi, lanes_max[k]);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        lo = MIN(lo, samples[i]);
+        hi = MAX(hi, samples[i]);
+    }
+    *min = lo;
+    *max = hi;
+}
+
+static void waveform_handoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer user_data) {
+    WaveformBuilder *builder = user_data;
+    GstMapInfo map;
+
+    if (builder->rate == 0) {
+        GstCaps *caps = gst_pad_get_current_caps(pad);
+        if (caps) {
+            GstStructure *s = gst_caps_get_structure(caps, 0);
+            gst_structure_get_int(s, "rate", &builder->rate);
+            gst_structure_get_int(s, "channels", &builder->channels);
+            gst_caps_unref(caps);
+        }
+        if (builder->rate <= 0 || builder->channels <= 0) {
+            builder->rate = 0;
+            return;
+        }
+        builder->slice_size = MAX(builder->rate / 100, 1) * builder->channels;
+    }
+
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ))
+        return;
+
+    const gfloat *samples = (const gfloat *)map.data;
+    gsize n = map.size / sizeof(gfloat);
+
+    while (n > 0) {
+        gsize take = MIN(n, builder->slice_size - builder->slice_fill);
+
+        peaks_minmax(samples, take, &builder->min, &builder->max);
+        samples += take;
+        n -= take;
+        builder->slice_fill += take;
+
+        if (builder->slice_fill == builder->slice_size) {
+            gfloat pair[2] = { builder->min, builder->max };
+            g_array_append_vals(builder->slices, pair, 2);
+            builder->slice_fill = 0;
+            builder->min = G_MAXFLOAT;
+            builder->max = -G_MAXFLOAT;
+        }
+    }
+    gst_buffer_unmap(buffer, &map);
+}
+
+/* Dosyayı çözüp WAVEFORM_BINS çiftlik özet üretir (işçi thread) */
+static gint8 *waveform_compute(const gchar *path) {
+    WaveformBuilder builder = { 0 };
+    gint8 *peaks = NULL;
+    gint64 start = g_get_monotonic_time();
+
+    builder.min = G_MAXFLOAT;
+    builder.max = -G_MAXFLOAT;
+    builder.slices = g_array_new(FALSE, FALSE, sizeof(gfloat));
+
+    if (decode_file_f32(path, G_CALLBACK(waveform_handoff), &builder) && builder.rate > 0) {
+        // Yarım kalan son dilim
+        if (builder.slice_fill > 0) {
+            gfloat pair[2] = { builder.min, builder.max };
+            g_array_append_vals(builder.slices, pair, 2);
+        }
+
+        guint slices = builder.slices->len / 2;
+        const gfloat *pairs = (const gfloat *)builder.slices->data;
+
+        peaks = g_new0(gint8, WAVEFORM_BINS * 2);
+        for (guint bin = 0; bin < WAVEFORM_BINS && slices > 0; bin++) {
+            guint first = (guint)((guint64)bin * slices / WAVEFORM_BINS);
+            guint last = MAX((guint)((guint64)(bin + 1) * slices / WAVEFORM_BINS), first + 1);
+            gfloat lo = G_MAXFLOAT, hi = -G_MAXFLOAT;
+
+            for (guint i = first; i < last && i < slices; i++) {
+                lo = MIN(lo, pairs[i * 2]);
+                hi = MAX(hi, pairs[i * 2 + 1]);
+            }
+            peaks[bin * 2] = (gint8)(CLAMP(lo, -1.0f, 1.0f) * 127);
+            peaks[bin * 2 + 1] = (gint8)(CLAMP(hi, -1.0f, 1.0f) * 127);
+        }
 
-    switch (GST_MESSAGE_TYPE(msg)) {
-    case GST_MESSAGE_EOS:
-        // Müzik bittiğinde otomatik olarak sonraki şarkıya geç
-        next_media(data);
-        break;
-    case GST_MESSAGE_ERROR:
-    {
-        GError *err;
-        gchar *debug_info;
-        gst_message_parse_error(msg, &err, &debug_info);
-        g_printerr("Hata: %s\n", err->message);
-        g_error_free(err);
-        g_free(debug_info);
-        stop_media(data);
-        break;
+        gdouble seconds = (gdouble)slices / 100.0;
+        gdouble elapsed = (g_get_monotonic_time() - start) / (gdouble)G_USEC_PER_SEC;
+        g_debug("Dalga formu: %.1f sn'lik parça %.3f sn'de (gerçek zamanın %.0f katı)",
+                seconds, elapsed, elapsed > 0 ? seconds / elapsed : 0.0);
     }
-    default:
-        break;
+
+    g_array_free(builder.slices, TRUE);
+    return peaks;
+}
+
+static gchar *waveform_cache_path(const gchar *path) {
+    gchar *hash = g_compute_checksum_for_string(G_CHECKSUM_SHA1, path, -1);
+    gchar *name = g_strconcat(hash, ".peaks", NULL);
+    gchar *cache = g_build_filename(g_get_user_cache_dir(), "mp3_player", "waveforms", name, NULL);
+
+    g_free(name);
+    g_free(hash);
+    return cache;
+}
+
+/* Diskteki özeti okur; dosya değişmişse ya da özet yoksa NULL */
+static gint8 *waveform_cache_load(const gchar *path, const GStatBuf *st) {
+    gchar *cache = waveform_cache_path(path);
+    gchar *contents = NULL;
+    gsize length = 0;
+    gint8 *peaks = NULL;
+
+    if (g_file_get_contents(cache, &contents, &length, NULL) &&
+        length == sizeof(WaveformHeader) + WAVEFORM_BINS * 2) {
+        WaveformHeader header;
+        memcpy(&header, contents, sizeof(header));
+
+        if (memcmp(header.magic, WAVEFORM_MAGIC, 4) == 0 && header.version == WAVEFORM_VERSION &&
+            header.mtime == (gint64)st->st_mtime && header.size == (gint64)st->st_size) {
+            peaks = g_memdup2(contents + sizeof(header), WAVEFORM_BINS * 2);
+        }
     }
-    return TRUE; 
+
+    g_free(contents);
+    g_free(cache);
+    return peaks;
 }
 
-/* Döngü (loop) toggle butonu tıklandığında çağrılır */
-static void on_loop_toggled(GtkToggleButton *toggle, gpointer user_data) {
-    PlayerData *data = (PlayerData *)user_data;
-    data->loop_enabled = gtk_toggle_button_get_active(toggle);
+static void waveform_cache_save(const gchar *path, const GStatBuf *st, const gint8 *peaks) {
+    gchar *cache = waveform_cache_path(path);
+    gchar *dir = g_path_get_dirname(cache);
+    gsize length = sizeof(WaveformHeader) + WAVEFORM_BINS * 2;
+    gchar *contents = g_malloc0(length);
+    WaveformHeader header = { .version = WAVEFORM_VERSION, .mtime = st->st_mtime, .size = st->st_size };
+
+    memcpy(header.magic, WAVEFORM_MAGIC, 4);
+    memcpy(contents, &header, sizeof(header));
+    memcpy(contents + sizeof(header), peaks, WAVEFORM_BINS * 2);
+
+    g_mkdir_with_parents(dir, 0755);
+    g_file_set_contents(cache, contents, length, NULL);
+
+    g_free(contents);
+    g_free(dir);
+    g_free(cache);
 }
 
-/* Playlist'teki satıra çift tık (row-activated) yapıldığında çağrılır */
-static void on_playlist_row_activated(GtkListBox *box, GtkListBoxRow *row, gpointer user_data) {
-    PlayerData *data = (PlayerData *)user_data;
-    int index = gtk_list_box_row_get_index(row);
+static void waveform_job_free(WaveformJob *job) {
+    g_free(job->path);
+    g_free(job->peaks);
+    g_free(job);
+}
 
-    if (index >= 0 && index < data->file_count) {
-        stop_media(data);
-        data->current_index = index;
+/* Sonucu ana thread'de teslim alır; iş hâlâ güncelse özet değiştirilir */
+static gboolean waveform_job_done(gpointer user_data) {
+    WaveformJob *job = user_data;
+    PlayerData *data = job->data;
 
-        gchar *uri = g_filename_to_uri(data->file_list[data->current_index], NULL, NULL);
-        if (uri) {
-            g_object_set(data->pipeline, "uri", uri, NULL);
-            g_free(uri);
-            play_media(data);
+    if (job->generation == g_atomic_int_get(&data->waveform_generation)) {
+        g_free(data->waveform_peaks);
+        data->waveform_peaks = job->peaks;
+        job->peaks = NULL;
+        g_clear_pointer(&data->waveform_surface, cairo_surface_destroy);
+        gtk_widget_queue_draw(data->slider);
+    }
+    waveform_job_free(job);
+    return G_SOURCE_REMOVE;
+}
+
+/* İşçi: önce diskteki özete bakar, yoksa (ve iş eskimediyse) dosyayı çözer */
+static void waveform_worker(gpointer task, gpointer user_data) {
+    WaveformJob *job = task;
+    GStatBuf st;
+
+    if (job->generation == g_atomic_int_get(&job->data->waveform_generation) &&
+        g_stat(job->path, &st) == 0) {
+        job->peaks = waveform_cache_load(job->path, &st);
+        if (!job->peaks) {
+            job->peaks = waveform_compute(job->path);
+            if (job->peaks)
+                waveform_cache_save(job->path, &st, job->peaks);
         }
-        update_labels_and_buttons(data);
     }
+    g_idle_add(waveform_job_done, job);
 }
 
-/* Playlist kutusunu yeniden oluşturur, mevcut şarkıyı vurgular. */
-static void refresh_playlist(PlayerData *data) {
-    // Mevcut satırları temizle
-    GList *children = gtk_container_get_children(GTK_CONTAINER(data->playlist_box));
-    for (GList *iter = children; iter != NULL; iter = iter->next) {
-        gtk_widget_destroy(GTK_WIDGET(iter->data));
+/* Çalan parçanın özetini ister; aynı parça için tekrar istenmez */
+static void waveform_request(PlayerData *data) {
+    if (!data->slider || playlist_store_count(data->playlist) == 0)
+        return;
+
+    const gchar *path = playlist_store_path(data->playlist, data->current_index);
+    if (g_strcmp0(path, data->waveform_path) == 0)
+        return;
+
+    g_free(data->waveform_path);
+    data->waveform_path = g_strdup(path);
+    g_clear_pointer(&data->waveform_peaks, g_free);
+    g_clear_pointer(&data->waveform_surface, cairo_surface_destroy);
+    gtk_widget_queue_draw(data->slider);
+
+    if (!data->waveform_pool) {
+        data->waveform_pool = g_thread_pool_new(waveform_worker, NULL, 1, FALSE, NULL);
     }
-    g_list_free(children);
 
-    // Yeni satırları ekle
-    for (int i = 0; i < data->file_count; i++) {
-        GtkWidget *row_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
-        GtkWidget *icon = gtk_image_new_from_icon_name("audio-x-generic", GTK_ICON_SIZE_MENU);
-        gchar *filename = g_path_get_basename(data->file_list[i]);
-        GtkWidget *label = gtk_label_new(filename);
+    WaveformJob *job = g_new0(WaveformJob, 1);
+    job->data = data;
+    job->path = g_strdup(path);
+    job->generation = g_atomic_int_add(&data->waveform_generation, 1) + 1;
+    g_thread_pool_push(data->waveform_pool, job, NULL);
+}
 
-        gtk_box_pack_start(GTK_BOX(row_box), icon, FALSE, FALSE, 6);
-        gtk_box_pack_start(GTK_BOX(row_box), label, FALSE, FALSE, 6);
+/* Özeti verilen boyutta bir yüzeye bir kez çizer */
+static void waveform_render(PlayerData *data, GtkWidget *widget, int width, int height) {
+    int scale = gtk_widget_get_scale_factor(widget);
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width * scale, height * scale);
+    cairo_surface_set_device_scale(surface, scale, scale);
 
-        // Seçili (çalınan) şarkıyı vurgulamak için CSS
-        if (i == data->current_index) {
-            GtkStyleContext *context = gtk_widget_get_style_context(row_box);
-            gtk_style_context_add_class(context, "selected-row");
-        }
+    cairo_t *cr = cairo_create(surface);
+    gdouble middle = height / 2.0;
 
-        gtk_widget_show_all(row_box);
-        gtk_list_box_insert(GTK_LIST_BOX(data->playlist_box), row_box, -1);
+    cairo_set_source_rgba(cr, 0.29, 0.45, 0.72, 0.35);
+    cairo_set_line_width(cr, 1.0);
+    for (int x = 0; x < width; x++) {
+        int first = x * WAVEFORM_BINS / width;
+        int last = MAX((x + 1) * WAVEFORM_BINS / width, first + 1);
+        gint8 lo = G_MAXINT8, hi = G_MININT8;
 
-        g_free(filename);
+        for (int bin = first; bin < last && bin < WAVEFORM_BINS; bin++) {
+            lo = MIN(lo, data->waveform_peaks[bin * 2]);
+            hi = MAX(hi, data->waveform_peaks[bin * 2 + 1]);
+        }
+        cairo_move_to(cr, x + 0.5, middle - hi * middle / 127.0);
+        cairo_line_to(cr, x + 0.5, middle - lo * middle / 127.0 + 1.0);
     }
+    cairo_stroke(cr);
+    cairo_destroy(cr);
+
+    data->waveform_surface = surface;
 }
 
-/* Etiketleri ve butonları günceller. */
-static void update_labels_and_buttons(PlayerData *data) {
-    // Şimdiki şarkı
-    gtk_label_set_text(GTK_LABEL(data->current_label),
-                       data->file_count > 0
-                           ? g_path_get_basename(data->file_list[data->current_index])
-                           : "Şu an çalan: Yok");
+/*
+ * Slider'dan önce çalışır: saklanan özet yüzeyini arkaplana kopyalar.
+ * Özet, topuzun merkezinin gezdiği aralığa (oluk eksi iki yanda yarım
+ * topuz) yerleşir; böylece topuz duyulan konumun üstünde durur.
+ */
+static gboolean on_slider_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    GdkRectangle trough;
+    gint slider_start, slider_end;
 
-    // Önceki şarkı
-    if (data->file_count > 1 && data->current_index > 0) {
-        gtk_label_set_text(GTK_LABEL(data->previous_label),
-                           g_path_get_basename(data->file_list[data->current_index - 1]));
-        gtk_widget_set_sensitive(data->previous_button, TRUE);
-    } else {
-        gtk_label_set_text(GTK_LABEL(data->previous_label), "Önceki: Yok");
-        gtk_widget_set_sensitive(data->previous_button, FALSE);
+    gtk_range_get_range_rect(GTK_RANGE(widget), &trough);
+    gtk_range_get_slider_range(GTK_RANGE(widget), &slider_start, &slider_end);
+    int knob = MAX(slider_end - slider_start, 0);
+    int left = trough.x + knob / 2;
+    int width = trough.width - knob;
+    int height = gtk_widget_get_allocated_height(widget);
+    int scale = gtk_widget_get_scale_factor(widget);
+
+    if (!data->waveform_peaks || width <= 0 || height <= 0)
+        return FALSE;
+
+    if (data->waveform_surface &&
+        (cairo_image_surface_get_width(data->waveform_surface) != width * scale ||
+         cairo_image_surface_get_height(data->waveform_surface) != height * scale)) {
+        g_clear_pointer(&data->waveform_surface, cairo_surface_destroy);
+    }
+    if (!data->waveform_surface) {
+        waveform_render(data, widget, width, height);
     }
 
-    // Sonraki şarkı
-    if (data->file_count > 1 && data->current_index < data->file_count - 1) {
-        gtk_label_set_text(GTK_LABEL(data->next_label),
-                           g_path_get_basename(data->file_list[data->current_index + 1]));
-        gtk_widget_set_sensitive(data->next_button, TRUE);
+    cairo_set_source_surface(cr, data->waveform_surface, left, 0);
+    cairo_paint(cr);
+    return FALSE;
+}
+
+/*
+ * ---- MP3 seek indeksi ----
+ * VBR MP3'lerde (Xing TOC yoksa) ayrıştırıcı bayt konumunu ortalama bit
+ * hızından tahmin eder: seek ya birkaç saniye sapar ya da ACCURATE
+ * bayrağıyla dosyayı tarar. Dosya ilk açıldığında çerçeveleri (frame)
+ * bir kez taranır ve her SEEK_INDEX_STRIDE çerçevede bir (bayt, zaman)
+ * çifti kaydedilir. İndeks diskte saklanır ve mpegaudioparse'ın kendi
+ * indeksine eklenir; böylece seek doğrudan en yakın çerçeveye atlar ve
+ * ACCURATE seek yalnızca o çerçeveden hedefe kadar çözer.
+ * Bayt konumları ID3v2 etiketinden sonrasına göredir (id3demux etiketi
+ * ayrıştırıcıya ulaşmadan keser).
+ */
+
+#define SEEK_INDEX_MAGIC   "MPSI"
+#define SEEK_INDEX_VERSION 1
+#define SEEK_INDEX_STRIDE  8   // Kayıtlar arası çerçeve sayısı (~0,2 s)
+#define SEEK_INDEX_MEMORY  32  // Bellekte tutulan en fazla indeks
+
+/* Diskteki indeksin başlığı; ardından count x SeekIndexEntry gelir */
+typedef struct {
+    gchar   magic[4];
+    guint32 version;
+    gint64  mtime;
+    gint64  size;
+    guint32 count;
+    guint32 reserved;
+} SeekIndexHeader;
+
+typedef struct {
+    guint64 offset; // Ses verisinin başından itibaren bayt
+    guint64 time;   // Çerçevenin başlangıç zamanı (ns)
+} SeekIndexEntry;
+
+/* Bir ayrıştırıcı için indeks işi */
+typedef struct {
+    PlayerData *data;
+    gchar      *path;
+    GWeakRef    parser; // İndeks hazır olunca kayıtların ekleneceği mpegaudioparse
+} SeekIndexJob;
+
+/* MPEG ses çerçeve başlığını çözer; geçersizse FALSE */
+static gboolean mp3_frame_header(const guint8 *p, guint *length, guint *samples, guint *rate) {
+    static const guint16 bitrates[5][15] = {
+        { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 }, // MPEG-1 Layer I
+        { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },    // MPEG-1 Layer II
+        { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 },     // MPEG-1 Layer III
+        { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },    // MPEG-2/2.5 Layer I
+        { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },         // MPEG-2/2.5 Layer II/III
+    };
+    static const guint rates[3] = { 44100, 48000, 32000 };
+
+    guint32 h = ((guint32)p[0] << 24) | ((guint32)p[1] << 16) | ((guint32)p[2] << 8) | p[3];
+    guint version = (h >> 19) & 3; // 0: 2.5, 2: 2, 3: 1
+    guint layer = 4 - ((h >> 17) & 3); // 1..3 (4: geçersiz)
+    guint bitrate_index = (h >> 12) & 15;
+    guint rate_index = (h >> 10) & 3;
+
+    if ((h & 0xFFE00000) != 0xFFE00000 || version == 1 || layer == 4 ||
+        bitrate_index == 0 || bitrate_index == 15 || rate_index == 3)
+        return FALSE;
+
+    gboolean mpeg1 = version == 3;
+    guint kbps = bitrates[mpeg1 ? layer - 1 : (layer == 1 ? 3 : 4)][bitrate_index];
+    guint padding = (h >> 9) & 1;
+
+    *rate = rates[rate_index] >> (mpeg1 ? 0 : (version == 2 ? 1 : 2));
+    if (layer == 1) {
+        *samples = 384;
+        *length = (12 * kbps * 1000 / *rate + padding) * 4;
     } else {
-        gtk_label_set_text(GTK_LABEL(data->next_label), "Sonraki: Yok");
-        gtk_widget_set_sensitive(data->next_button, FALSE);
+        *samples = layer == 3 && !mpeg1 ? 576 : 1152;
+        *length = (*samples / 8) * kbps * 1000 / *rate + padding;
     }
+    return TRUE;
+}
 
-    // Eğer oynuyorsa buton ikonu pause, duraklatılmışsa play göster
-    if (data->is_playing) {
-        gtk_button_set_image(GTK_BUTTON(data->play_button),
-                             gtk_image_new_from_icon_name("media-playback-pause-symbolic", GTK_ICON_SIZE_BUTTON));
-    } else {
-        gtk_button_set_image(GTK_BUTTON(data->play_button),
-                             gtk_image_new_from_icon_name("media-playback-start-symbolic", GTK_ICON_SIZE_BUTTON));
+/* Dosyanın çerçevelerini tarar; MPEG ses dosyası değilse NULL */
+static GArray *seek_index_build(const gchar *path) {
+    GMappedFile *file = g_mapped_file_new(path, FALSE, NULL);
+    if (!file)
+        return NULL;
+
+    const guint8 *data = (const guint8 *)g_mapped_file_get_contents(file);
+    gsize size = g_mapped_file_get_length(file);
+    gsize start = 0;
+
+    // ID3v2 etiketi (boyut syncsafe, altbilgi varsa +10)
+    if (size >= 10 && memcmp(data, "ID3", 3) == 0) {
+        start = 10 + (((gsize)data[6] & 0x7F) << 21 | ((gsize)data[7] & 0x7F) << 14 |
+                      ((gsize)data[8] & 0x7F) << 7 | ((gsize)data[9] & 0x7F));
+        if (data[5] & 0x10)
+            start += 10;
     }
 
-    // Playlisti güncelle
-    refresh_playlist(data);
-}
+    GArray *entries = g_array_new(FALSE, FALSE, sizeof(SeekIndexEntry));
+    guint64 sample = 0;
+    guint frames = 0, rate = 0;
+    gsize p = start;
 
-/* Müzik oynat/duraklat fonksiyonu */
-static void play_media(PlayerData *data) {
-    if (!data->pipeline) {
-        g_print("Hata: Pipeline başlatılmadı!\n");
-        return;
+    while (p + 4 <= size) {
+        guint length, samples, frame_rate, next_length, next_samples, next_rate;
+
+        // Çerçeve, ardından başka bir çerçeve (ya da dosya sonu) geliyorsa kabul edilir
+        if (!mp3_frame_header(data + p, &length, &samples, &frame_rate) ||
+            (p + length + 4 <= size &&
+             !mp3_frame_header(data + p + length, &next_length, &next_samples, &next_rate)) ||
+            (rate && frame_rate != rate)) {
+            p++;
+            continue;
+        }
+
+        // İlk çerçeve Xing/Info/VBRI başlığıysa ayrıştırıcı onu çıkarmaz: örnekleri sayılmaz
+        gboolean info = FALSE;
+        if (frames == 0) {
+            for (gsize i = p + 4; i + 4 <= MIN(p + 48, size); i++) {
+                if (memcmp(data + i, "Xing", 4) == 0 || memcmp(data + i, "Info", 4) == 0 ||
+                    memcmp(data + i, "VBRI", 4) == 0) {
+                    info = TRUE;
+                    break;
+                }
+            }
+        }
+
+        if (!info) {
+            if (frames % SEEK_INDEX_STRIDE == 0) {
+                SeekIndexEntry entry = { p - start, gst_util_uint64_scale(sample, GST_SECOND, frame_rate) };
+                g_array_append_val(entries, entry);
+            }
+            sample += samples;
+            frames++;
+        }
+        rate = frame_rate;
+        p += length;
     }
+    g_mapped_file_unref(file);
 
-    if (!data->is_playing) {
-        gst_element_set_state(data->pipeline, GST_STATE_PLAYING);
-        data->is_playing = TRUE;
-        // Buton ikonu güncelle
-        gtk_button_set_image(GTK_BUTTON(data->play_button),
-                             gtk_image_new_from_icon_name("media-playback-pause-symbolic", GTK_ICON_SIZE_BUTTON));
-        g_timeout_add(500, (GSourceFunc)update_slider, data);
-    } else {
-        gst_element_set_state(data->pipeline, GST_STATE_PAUSED);
-        data->is_playing = FALSE;
-        // Buton ikonu güncelle
-        gtk_button_set_image(GTK_BUTTON(data->play_button),
-                             gtk_image_new_from_icon_name("media-playback-start-symbolic", GTK_ICON_SIZE_BUTTON));
+    if (frames == 0) {
+        g_array_free(entries, TRUE);
+        return NULL;
     }
+    return entries;
 }
 
-/* Müzik durdurma fonksiyonu */
-static void stop_media(PlayerData *data) {
-    if (data->pipeline) {
-        gst_element_set_state(data->pipeline, GST_STATE_NULL);
+static gchar *seek_index_cache_path(const gchar *path) {
+    gchar *hash = g_compute_checksum_for_string(G_CHECKSUM_SHA1, path, -1);
+    gchar *name = g_strconcat(hash, ".idx", NULL);
+    gchar *cache = g_build_filename(g_get_user_cache_dir(), "mp3_player", "seekindex", name, NULL);
+
+    g_free(name);
+    g_free(hash);
+    return cache;
+}
+
+/* Diskteki indeksi okur; dosya değişmişse ya da indeks yoksa NULL */
+static GArray *seek_index_cache_load(const gchar *path, const GStatBuf *st) {
+    gchar *cache = seek_index_cache_path(path);
+    gchar *contents = NULL;
+    gsize length = 0;
+    GArray *entries = NULL;
+
+    if (g_file_get_contents(cache, &contents, &length, NULL) && length >= sizeof(SeekIndexHeader)) {
+        SeekIndexHeader header;
+        memcpy(&header, contents, sizeof(header));
+
+        if (memcmp(header.magic, SEEK_INDEX_MAGIC, 4) == 0 && header.version == SEEK_INDEX_VERSION &&
+            header.mtime == (gint64)st->st_mtime && header.size == (gint64)st->st_size &&
+            length == sizeof(header) + (gsize)header.count * sizeof(SeekIndexEntry)) {
+            entries = g_array_sized_new(FALSE, FALSE, sizeof(SeekIndexEntry), header.count);
+            g_array_append_vals(entries, contents + sizeof(header), header.count);
+        }
     }
-    data->is_playing = FALSE;
-    // Buton ikonu güncelle
-    gtk_button_set_image(GTK_BUTTON(data->play_button),
-                         gtk_image_new_from_icon_name("media-playback-start-symbolic", GTK_ICON_SIZE_BUTTON));
 
-    gtk_range_set_value(GTK_RANGE(data->slider), 0);
+    g_free(contents);
+    g_free(cache);
+    return entries;
 }
 
-/* Slider'ı ve zaman etiketini güncelleyen fonksiyon (her 500 ms çağrılır) */
-static gboolean update_slider(PlayerData *data) {
-    if (!data->is_playing || !data->pipeline)
-        return G_SOURCE_REMOVE;
+static void seek_index_cache_save(const gchar *path, const GStatBuf *st, GArray *entries) {
+    gchar *cache = seek_index_cache_path(path);
+    gchar *dir = g_path_get_dirname(cache);
+    gsize length = sizeof(SeekIndexHeader) + entries->len * sizeof(SeekIndexEntry);
+    gchar *contents = g_malloc0(length);
+    SeekIndexHeader header = { .version = SEEK_INDEX_VERSION, .mtime = st->st_mtime,
+                               .size = st->st_size, .count = entries->len };
 
-    gint64 position = -1, duration = -1;
+    memcpy(header.magic, SEEK_INDEX_MAGIC, 4);
+    memcpy(contents, &header, sizeof(header));
+    memcpy(contents + sizeof(header), entries->data, entries->len * sizeof(SeekIndexEntry));
 
-    if (gst_element_query_position(data->pipeline, GST_FORMAT_TIME, &position) &&
-        gst_element_query_duration(data->pipeline, GST_FORMAT_TIME, &duration)) {
-        gtk_range_set_range(GTK_RANGE(data->slider), 0, (gdouble)duration / GST_SECOND);
-        gtk_range_set_value(GTK_RANGE(data->slider), (gdouble)position / GST_SECOND);
+    g_mkdir_with_parents(dir, 0755);
+    g_file_set_contents(cache, contents, length, NULL);
 
-        gint64 pos_minutes = position / (GST_SECOND * 60);
-        gint64 pos_seconds = (position / GST_SECOND) % 60;
-        gint64 dur_minutes = duration / (GST_SECOND * 60);
-        gint64 dur_seconds = (duration / GST_SECOND) % 60;
+    g_free(contents);
+    g_free(dir);
+    g_free(cache);
+}
 
-        gchar *time_text = g_strdup_printf("%02lld:%02lld / %02lld:%02lld",
-                                           pos_minutes, pos_seconds,
-                                           dur_minutes, dur_seconds);
-        gtk_label_set_text(GTK_LABEL(data->time_label), time_text);
-        g_free(time_text);
+/* Kayıtları ayrıştırıcının indeksine ekler (herhangi bir thread'den) */
+static void seek_index_apply(GstElement *parser, GArray *entries) {
+    for (guint i = 0; i < entries->len; i++) {
+        const SeekIndexEntry *entry = &g_array_index(entries, SeekIndexEntry, i);
+        gst_base_parse_add_index_entry(GST_BASE_PARSE(parser), entry->offset, entry->time, TRUE, TRUE);
     }
-    return G_SOURCE_CONTINUE;
 }
 
-/* Slider'dan konum değiştirildiğinde çağrılır */
-static void seek_to_position(GtkRange *range, PlayerData *data) {
-    gdouble value = gtk_range_get_value(range);
-    gst_element_seek_simple(data->pipeline, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH,
-                            (gint64)(value * GST_SECOND));
+static void seek_index_job_free(SeekIndexJob *job) {
+    g_weak_ref_clear(&job->parser);
+    g_free(job->path);
+    g_free(job);
 }
 
-/*
- * Sonraki şarkıya geçme fonksiyonu.
- * loop_enabled -> TRUE ise, listenin sonuna gelince başa sarar (mod %).
- * loop_enabled -> FALSE ise, son şarkıdan sonra durur.
- */
-static void next_media(PlayerData *data) {
-    if (data->file_count > 0) {
-        stop_media(data);
+/* İşçi: indeksi diskten okur ya da kurar, ayrıştırıcı hâlâ varsa ona ekler */
+static void seek_index_worker(gpointer task, gpointer user_data) {
+    SeekIndexJob *job = task;
+    PlayerData *data = job->data;
+    GStatBuf st;
+    GArray *entries = NULL;
 
-        if (data->loop_enabled) {
-            data->current_index = (data->current_index + 1) % data->file_count;
-        } else {
-            if (data->current_index < data->file_count - 1) {
-                data->current_index++;
-            } else {
-                // Son şarkıdayız, dur
-                stop_media(data);
-                return;
+    if (g_stat(job->path, &st) == 0) {
+        entries = seek_index_cache_load(job->path, &st);
+        if (!entries) {
+            gint64 start = g_get_monotonic_time();
+            entries = seek_index_build(job->path);
+            if (entries) {
+                seek_index_cache_save(job->path, &st, entries);
+                g_debug("Seek indeksi: %s (%u kayıt, %.1f ms)", job->path, entries->len,
+                        (g_get_monotonic_time() - start) / 1000.0);
             }
         }
+    }
 
-        gchar *uri = g_filename_to_uri(data->file_list[data->current_index], NULL, NULL);
-        if (uri) {
-            g_object_set(data->pipeline, "uri", uri, NULL);
-            g_free(uri);
-            play_media(data);
-            update_labels_and_buttons(data);
+    if (entries) {
+        GstElement *parser = g_weak_ref_get(&job->parser);
+        if (parser) {
+            seek_index_apply(parser, entries);
+            gst_object_unref(parser);
         }
+
+        g_mutex_lock(&data->seek_index_lock);
+        if (g_hash_table_size(data->seek_indexes) >= SEEK_INDEX_MEMORY)
+            g_hash_table_remove_all(data->seek_indexes);
+        g_hash_table_insert(data->seek_indexes, g_strdup(job->path), entries);
+        g_mutex_unlock(&data->seek_index_lock);
     }
+    seek_index_job_free(job);
 }
 
-/* Önceki şarkıya geç */
-static void previous_media(PlayerData *data) {
-    if (data->file_count > 0) {
-        stop_media(data);
-        data->current_index = (data->current_index - 1 + data->file_count) % data->file_count;
+/* Elemanın içinde bulunduğu uridecodebin'in çaldığı yerel dosya (yoksa NULL) */
+static gchar *element_source_path(GstElement *element) {
+    GstObject *parent = gst_object_get_parent(GST_OBJECT(element));
+    gchar *uri = NULL;
 
-        gchar *uri = g_filename_to_uri(data->file_list[data->current_index], NULL, NULL);
-        if (uri) {
-            g_object_set(data->pipeline, "uri", uri, NULL);
-            g_free(uri);
-            play_media(data);
-            update_labels_and_buttons(data);
-        }
+    while (parent && !uri) {
+        if (g_object_class_find_property(G_OBJECT_GET_CLASS(parent), "uri"))
+            g_object_get(parent, "uri", &uri, NULL);
+
+        GstObject *next = gst_object_get_parent(parent);
+        gst_object_unref(parent);
+        parent = next;
     }
+    if (parent)
+        gst_object_unref(parent);
+
+    gchar *path = uri ? g_filename_from_uri(uri, NULL, NULL) : NULL;
+    g_free(uri);
+    return path;
 }
 
-/* Dosyalar seçildiğinde çağrılır */
-static void file_chosen(GtkWidget *widget, gpointer user_data) {
+/*
+ * mpegaudioparse'ın girişindeki ilk STREAM_START (streaming thread). Ayrıştırıcı
+ * kendi indeksini PAUSED'a geçerken kurduğu için kayıtlar ancak bundan sonra
+ * eklenebilir. İndeks bellekte yoksa işçi kurar ve hazır olunca ekler.
+ */
+static GstPadProbeReturn seek_index_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
     PlayerData *data = (PlayerData *)user_data;
-    GtkFileChooser *chooser = GTK_FILE_CHOOSER(widget);
-    GSList *files = gtk_file_chooser_get_filenames(chooser);
 
-    if (files != NULL) {
-        stop_media(data);
+    if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) != GST_EVENT_STREAM_START)
+        return GST_PAD_PROBE_OK;
 
-        // Eski listeyi temizle
-        if (data->file_list) {
-            for (int i = 0; i < data->file_count; i++) {
-                g_free(data->file_list[i]);
-            }
-            g_free(data->file_list);
-        }
+    GstElement *parser = gst_pad_get_parent_element(pad);
+    gchar *path = parser ? element_source_path(parser) : NULL;
 
-        // Yeni listeyi oluştur
-        data->file_count = g_slist_length(files);
-        data->file_list = g_new(gchar *, data->file_count);
+    if (path) {
+        g_mutex_lock(&data->seek_index_lock);
+        GArray *entries = g_hash_table_lookup(data->seek_indexes, path);
+        if (entries)
+            seek_index_apply(parser, entries);
+        g_mutex_unlock(&data->seek_index_lock);
 
-        int i = 0;
-        for (GSList *node = files; node != NULL; node = node->next, i++) {
-            data->file_list[i] = g_strdup((gchar *)node->data);
+        if (entries) {
+            g_free(path);
+        } else {
+            SeekIndexJob *job = g_new0(SeekIndexJob, 1);
+            job->data = data;
+            job->path = path;
+            g_weak_ref_init(&job->parser, parser);
+            g_thread_pool_push(data->seek_index_pool, job, NULL);
         }
-        g_slist_free_full(files, g_free);
+    }
+    if (parser)
+        gst_object_unref(parser);
+    return GST_PAD_PROBE_REMOVE;
+}
 
-        data->current_index = 0;
+/* Pipeline'a (alt bin'ler dahil) eklenen mpegaudioparse'ları izler */
+static void seek_index_on_element_added(GstBin *bin, GstBin *sub_bin, GstElement *element,
+                                        gpointer user_data) {
+    GstElementFactory *factory = gst_element_get_factory(element);
 
-        // İlk şarkıyı yükle ve çal
-        gchar *uri = g_filename_to_uri(data->file_list[data->current_index], NULL, NULL);
-        if (uri) {
-            g_object_set(data->pipeline, "uri", uri, NULL);
-            g_free(uri);
-            play_media(data);
-        }
-        update_labels_and_buttons(data);
+    if (!factory || !GST_IS_BASE_PARSE(element) ||
+        g_strcmp0(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)), "mpegaudioparse") != 0)
+        return;
+
+    GstPad *pad = gst_element_get_static_pad(element, "sink");
+    if (pad) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, seek_index_probe, user_data, NULL);
+        gst_object_unref(pad);
     }
 }
 
-/* Dosya seçme diyalogunu açar */
-static void choose_file(GtkWidget *button, gpointer user_data) {
-    PlayerData *data = (PlayerData *)user_data;
-    GtkWidget *dialog = gtk_file_chooser_dialog_new("Dosya Seç",
-                                                    GTK_WINDOW(gtk_widget_get_toplevel(button)),
-                                                    GTK_FILE_CHOOSER_ACTION_OPEN,
-                                                    "İptal", GTK_RESPONSE_CANCEL,
-                                                    "Seç", GTK_RESPONSE_ACCEPT,
-                                                    NULL);
+/*
+ * ---- Oturum ----
+ * Playlist, çalan parça, konum ve döngü ayarı kapanışta tek bir ikili
+ * dosyaya yazılır:
+ *
+ *   SessionHeader | count x SessionRecord | metinler ('\0' ile biten)
+ *
+ * Açılışta dosya belleğe eşlenir (mmap) ve metinler kopyalanmadan
+ * PlaylistStore'a bağlanır; sanal liste modeli yalnızca görünen satırları
+ * okuduğu için büyük oturumlar da pencere açıldıktan hemen sonra hazırdır.
+ * Son parça duraklatılmış olarak kaydedilen konumda yüklenir.
+ */
 
-    GtkFileFilter *filter = gtk_file_filter_new();
-    gtk_file_filter_set_name(filter, "MP3 Dosyaları");
-    gtk_file_filter_add_pattern(filter, "*.mp3");
-    gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
-    gtk_file_chooser_set_select_multiple(GTK_FILE_CHOOSER(dialog), TRUE);
+#define SESSION_MAGIC   "MPSS"
+#define SESSION_VERSION 1
+#define SESSION_NONE    G_MAXUINT32 // Olmayan metin
 
-    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
-        file_chosen(dialog, data);
+typedef struct {
+    gchar   magic[4];
+    guint32 version;
+    guint32 count;
+    gint32  current_index;
+    guint64 position;     // ns (GST_CLOCK_TIME_NONE: bilinmiyor)
+    guint32 loop_enabled;
+    guint32 text_size;
+} SessionHeader;
+
+typedef struct {
+    guint32 path;      // Metin alanındaki konumlar (SESSION_NONE: yok)
+    guint32 title;
+    guint32 artist;
+    guint32 base_off;
+    guint64 duration;
+} SessionRecord;
+
+static gchar *session_path(void) {
+    return g_build_filename(g_get_user_cache_dir(), "mp3_player", "session.bin", NULL);
+}
+
+static guint32 session_add_text(GString *text, const gchar *value) {
+    if (!value)
+        return SESSION_NONE;
+
+    guint32 offset = (guint32)text->len;
+    g_string_append_len(text, value, strlen(value) + 1);
+    return offset;
+}
+
+/* Oturumu path'e yazar */
+static gboolean session_save(PlayerData *data, const gchar *path) {
+    int count = playlist_store_count(data->playlist);
+    GString *text = g_string_new(NULL);
+    SessionRecord *records = g_new(SessionRecord, MAX(count, 1));
+    gint64 position = -1;
+
+    for (int i = 0; i < count; i++) {
+        const PlaylistEntry *entry = playlist_store_get(data->playlist, i);
+        records[i].path = session_add_text(text, entry->path);
+        records[i].title = session_add_text(text, entry->title);
+        records[i].artist = session_add_text(text, entry->artist);
+        records[i].base_off = entry->base_off;
+        records[i].duration = entry->duration;
     }
+    if (count > 0)
+        player_query_position(data, &position);
 
-    gtk_widget_destroy(dialog);
+    SessionHeader header = {
+        .version = SESSION_VERSION,
+        .count = (guint32)count,
+        .current_index = data->current_index,
+        .position = position >= 0 ? (guint64)position : GST_CLOCK_TIME_NONE,
+        .loop_enabled = data->loop_enabled,
+        .text_size = (guint32)text->len,
+    };
+    memcpy(header.magic, SESSION_MAGIC, 4);
+
+    gsize length = sizeof(header) + count * sizeof(SessionRecord) + text->len;
+    gchar *contents = g_malloc(length);
+    memcpy(contents, &header, sizeof(header));
+    memcpy(contents + sizeof(header), records, count * sizeof(SessionRecord));
+    memcpy(contents + sizeof(header) + count * sizeof(SessionRecord), text->str, text->len);
+
+    gchar *dir = g_path_get_dirname(path);
+    g_mkdir_with_parents(dir, 0755);
+    gboolean ok = g_file_set_contents(path, contents, length, NULL);
+
+    g_free(dir);
+    g_free(contents);
+    g_free(records);
+    g_string_free(text, TRUE);
+    return ok;
 }
 
-/* Ana pencere oluşturulduğunda çağrılır */
-static void activate(GtkApplication *app, gpointer user_data) {
-    // PlayerData yapımızı oluştur
+/*
+ * Oturumu eşler ve playlist'i onunla değiştirir. Kaydedilen konumu
+ * position'a yazar; dosya yoksa ya da bozuksa FALSE.
+ */
+static gboolean session_load(PlayerData *data, const gchar *path, GstClockTime *position) {
+    GMappedFile *file = g_mapped_file_new(path, FALSE, NULL);
+    if (!file)
+        return FALSE;
+
+    const gchar *contents = g_mapped_file_get_contents(file);
+    gsize length = g_mapped_file_get_length(file);
+    SessionHeader header;
+
+    if (length < sizeof(header)) {
+        g_mapped_file_unref(file);
+        return FALSE;
+    }
+    memcpy(&header, contents, sizeof(header));
+
+    gsize text_start = sizeof(header) + (gsize)header.count * sizeof(SessionRecord);
+    if (memcmp(header.magic, SESSION_MAGIC, 4) != 0 || header.version != SESSION_VERSION ||
+        length != text_start + header.text_size ||
+        (header.text_size > 0 && contents[length - 1] != '\0')) {
+        g_mapped_file_unref(file);
+        return FALSE;
+    }
+
+    const SessionRecord *records = (const SessionRecord *)(contents + sizeof(header));
+    const gchar *text = contents + text_start;
+
+    playlist_store_clear(data->playlist);
+    playlist_store_adopt(data->playlist, file);
+    for (guint32 i = 0; i < header.count; i++) {
+        const SessionRecord *record = &records[i];
+        if (record->path >= header.text_size)
+            continue;
+
+        // Bozuk dosyada dosya adı yolun dışını göstermesin
+        gsize path_length = strnlen(text + record->path, header.text_size - record->path);
+        PlaylistEntry entry = {
+            .path = text + record->path,
+            .title = record->title < header.text_size ? text + record->title : NULL,
+            .artist = record->artist < header.text_size ? text + record->artist : NULL,
+            .duration = record->duration,
+            .base_off = record->base_off <= path_length ? record->base_off : 0,
+        };
+        playlist_store_append_entry(data->playlist, &entry);
+    }
+
+    int count = playlist_store_count(data->playlist);
+    data->current_index = header.current_index >= 0 && header.current_index < count
+                          ? header.current_index : 0;
+    data->loop_enabled = header.loop_enabled != 0;
+    *position = header.position;
+    return TRUE;
+}
+
+/* Kapanışta (pencere kapanırken ya da headless çıkışta) oturumu kaydeder */
+static void session_store(PlayerData *data) {
+    gchar *path = session_path();
+    if (!session_save(data, path))
+        g_printerr("Hata: Oturum kaydedilemedi: %s\n", path);
+    g_free(path);
+}
+
+/* Son oturumu yükler ve parçayı kaydedilen konumda duraklatılmış hazırlar */
+static gboolean session_restore(PlayerData *data) {
+    gchar *path = session_path();
+    GstClockTime position = GST_CLOCK_TIME_NONE;
+    gint64 start = g_get_monotonic_time();
+    gboolean ok = session_load(data, path, &position);
+    g_free(path);
+
+    if (!ok || playlist_store_count(data->playlist) == 0)
+        return FALSE;
+
+    if (data->loop_toggle)
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(data->loop_toggle), data->loop_enabled);
+    refresh_playlist(data);
+
+    if (player_load(data, data->current_index)) {
+        // Konuma seek, preroll bitince (ASYNC_DONE) yapılır
+        data->restore_position = position;
+        player_set_state(data, GST_STATE_PAUSED);
+    }
+    update_labels_and_buttons(data);
+    g_debug("Oturum yüklendi: %d parça, %.1f ms", playlist_store_count(data->playlist),
+            (g_get_monotonic_time() - start) / 1000.0);
+    return TRUE;
+}
+
+static gboolean session_restore_idle(gpointer user_data) {
+    session_restore((PlayerData *)user_data);
+    return G_SOURCE_REMOVE;
+}
+
+static void on_window_destroy(GtkWidget *window, gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+
+    session_store(data);
+    stop_media(data);
+    player_control_shutdown(data);
+}
+
+/*
+ * Çalma çekirdeğini (playbin, boşluksuz geçiş, bus) oluşturur.
+ * GTK arayüzü, headless mod ve benchmark bunu kullanır.
+ * audio_sink_name: kullanılacak ses sink'inin fabrika adı (ör. "autoaudiosink").
+ */
+static PlayerData *player_new(const gchar *audio_sink_name) {
     PlayerData *data = g_new0(PlayerData, 1);
 
+    data->playlist = playlist_store_new();
+    data->duration = GST_CLOCK_TIME_NONE;
+    data->restore_position = GST_CLOCK_TIME_NONE;
+
     // GStreamer playbin oluştur
-    data->pipeline = gst_element_factory_make("playbin", "player");
-    if (!data->pipeline) {
+    data->playbin = gst_element_factory_make("playbin", "player");
+    if (!data->playbin) {
         g_print("Hata: GStreamer pipeline oluşturulamadı.\n");
         g_free(data);
-        return;
+        return NULL;
+    }
+    data->pipeline = data->playbin;
+    data->audio_sink_name = g_strdup(audio_sink_name);
+
+    // Boşluksuz geçiş: parça bitmeden sonrakini kuyruğa al
+    g_mutex_init(&data->gapless_lock);
+    data->gapless_enabled = TRUE;
+    data->gapless_index = -1;
+    data->queued_index = -1;
+    data->gap_probe.last_end = GST_CLOCK_TIME_NONE;
+    gst_segment_init(&data->gap_probe.segment, GST_FORMAT_UNDEFINED);
+    g_signal_connect(data->playbin, "about-to-finish", G_CALLBACK(on_about_to_finish), data);
+
+    // playbin durum değişimleri ana thread'i bekletmesin
+    player_control_init(data);
+    player_queue_init(data);
+
+    // Çalma hattı ölçümleri
+    stats_init(&data->stats);
+    g_signal_connect(data->playbin, "deep-element-added", G_CALLBACK(stats_on_element_added), &data->stats);
+    g_timeout_add_seconds(1, stats_tick, data);
+
+    // MP3 seek indeksi: ayrıştırıcı oluşturuldukça dosyanın indeksi verilir
+    g_mutex_init(&data->seek_index_lock);
+    data->seek_indexes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_array_unref);
+    data->seek_index_pool = g_thread_pool_new(seek_index_worker, NULL, 1, FALSE, NULL);
+    g_signal_connect(data->playbin, "deep-element-added", G_CALLBACK(seek_index_on_element_added), data);
+
+    // Sıradaki parçaların önden okunması
+    g_mutex_init(&data->prefetch_lock);
+    data->prefetch_state = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+    // Ses yüksekliği normalizasyonu: önbellekteki kazanç audio-filter'daki volume ile uygulanır
+    g_mutex_init(&data->loudness_lock);
+    g_mutex_init(&data->fingerprint_lock);
+    data->normalize_enabled = TRUE;
+    data->loudness_index = loudness_index_load();
+    data->normalize_volume = gst_element_factory_make("volume", "normalize");
+    if (data->normalize_volume) {
+        GstPad *filter_pad = gst_element_get_static_pad(data->normalize_volume, "sink");
+        gst_pad_add_probe(filter_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, normalize_probe_cb, data, NULL);
+        gst_object_unref(filter_pad);
+        // Ekolayzer ve sınırlayıcı normalizasyon kazancından sonra çalışır
+        g_object_set(data->playbin, "audio-filter", equalizer_filter_new(data, data->normalize_volume), NULL);
+    }
+
+    // Geçiş sessizliğini ölçmek için ses sink'ini kendimiz oluşturup probe ekliyoruz
+    GstElement *audio_sink = gst_element_factory_make(audio_sink_name, "audio-sink");
+    if (audio_sink) {
+        GstPad *sink_pad = gst_element_get_static_pad(audio_sink, "sink");
+        gst_pad_add_probe(sink_pad,
+                          GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+                          gap_probe_cb, data, NULL);
+        gst_object_unref(sink_pad);
+        g_object_set(data->playbin, "audio-sink", audio_sink, NULL);
     }
 
     // GStreamer pipeline ile ilgili bus ayarlarını yap
-    GstBus *bus = gst_element_get_bus(data->pipeline);
+    GstBus *bus = gst_element_get_bus(data->playbin);
+    gst_bus_set_sync_handler(bus, player_bus_stamp, data, NULL);
     gst_bus_add_watch(bus, bus_callback, data);
     gst_object_unref(bus);
 
+    return data;
+}
+
+/* Ana pencere oluşturulduğunda çağrılır */
+static void activate(GtkApplication *app, gpointer user_data) {
+    // PlayerData yapımızı oluştur
+    PlayerData *data = player_new("autoaudiosink");
+    if (!data)
+        return;
+
     // Ana pencere
     GtkWidget *window = gtk_application_window_new(app);
+    player_build_ui(data, window);
+    g_signal_connect(window, "destroy", G_CALLBACK(on_window_destroy), data);
+    gtk_widget_show_all(window);
+
+    // Pencere önce çizilir, son oturum ardından yüklenir
+    g_idle_add(session_restore_idle, data);
+}
+
+/* Verilen pencerenin içini (kontroller, slider, playlist) kurar */
+static void player_build_ui(PlayerData *data, GtkWidget *window) {
+    data->window = window;
     gtk_window_set_title(GTK_WINDOW(window), "MP3 Çalar");
     gtk_window_set_default_size(GTK_WINDOW(window), 900, 550);
     gtk_window_set_position(GTK_WINDOW(window), GTK_WIN_POS_CENTER);
+    g_signal_connect(window, "window-state-event", G_CALLBACK(on_window_state_event), data);
 
     // Ana kutu (vertical box)
     GtkWidget *main_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
@@ -394,6 +6136,44 @@ static void activate(GtkApplication *app, gpointer user_data) {
     g_signal_connect(choose_btn, "clicked", G_CALLBACK(choose_file), data);
     gtk_box_pack_start(GTK_BOX(file_box), choose_btn, FALSE, FALSE, 0);
 
+    GtkWidget *folder_btn = gtk_button_new_with_label(" Klasör Ekle ");
+    gtk_button_set_image(GTK_BUTTON(folder_btn),
+                         gtk_image_new_from_icon_name("folder-music-symbolic", GTK_ICON_SIZE_BUTTON));
+    gtk_widget_set_tooltip_text(folder_btn, "Klasör(ler)i Tara ve Listeye Ekle");
+    g_signal_connect(folder_btn, "clicked", G_CALLBACK(choose_folder), data);
+    gtk_box_pack_start(GTK_BOX(file_box), folder_btn, FALSE, FALSE, 0);
+
+    GtkWidget *analyze_btn = gtk_button_new_with_label(" Ses Analizi ");
+    gtk_button_set_image(GTK_BUTTON(analyze_btn),
+                         gtk_image_new_from_icon_name("audio-volume-high-symbolic", GTK_ICON_SIZE_BUTTON));
+    gtk_widget_set_tooltip_text(analyze_btn, "Listedeki Parçaların Ses Yüksekliğini Ölç");
+    g_signal_connect(analyze_btn, "clicked", G_CALLBACK(on_analyze_clicked), data);
+    gtk_box_pack_start(GTK_BOX(file_box), analyze_btn, FALSE, FALSE, 0);
+
+    GtkWidget *duplicates_btn = gtk_button_new_with_label(" Kopyaları Bul ");
+    gtk_button_set_image(GTK_BUTTON(duplicates_btn),
+                         gtk_image_new_from_icon_name("edit-copy-symbolic", GTK_ICON_SIZE_BUTTON));
+    gtk_widget_set_tooltip_text(duplicates_btn, "Listede Aynı Şarkının Kopyalarını Ara");
+    g_signal_connect(duplicates_btn, "clicked", G_CALLBACK(on_duplicates_clicked), data);
+    gtk_box_pack_start(GTK_BOX(file_box), duplicates_btn, FALSE, FALSE, 0);
+
+    // Normalizasyon toggle butonu (varsayılan: açık, ölçülmüş parçalara uygulanır)
+    GtkWidget *normalize_toggle = gtk_toggle_button_new_with_label(" Normalleştir ");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(normalize_toggle), data->normalize_enabled);
+    g_signal_connect(normalize_toggle, "toggled", G_CALLBACK(on_normalize_toggled), data);
+    gtk_widget_set_tooltip_text(normalize_toggle, "Parçaların Ses Yüksekliğini Eşitle");
+    gtk_box_pack_start(GTK_BOX(file_box), normalize_toggle, FALSE, FALSE, 0);
+
+    // Ekolayzer ön ayarları (çalma sırasında değiştirilebilir)
+    GtkWidget *eq_combo = gtk_combo_box_text_new();
+    for (guint i = 0; i < G_N_ELEMENTS(eq_presets); i++) {
+        gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(eq_combo), eq_presets[i].name, eq_presets[i].label);
+    }
+    gtk_combo_box_set_active(GTK_COMBO_BOX(eq_combo), data->eq_preset);
+    g_signal_connect(eq_combo, "changed", G_CALLBACK(on_equalizer_changed), data);
+    gtk_widget_set_tooltip_text(eq_combo, "Ekolayzer Ön Ayarı");
+    gtk_box_pack_start(GTK_BOX(file_box), eq_combo, FALSE, FALSE, 0);
+
     /*
      * Oynatma butonları ve önceki/sonraki etiketleri tutacak yatay kutu.
      */
@@ -438,6 +6218,47 @@ static void activate(GtkApplication *app, gpointer user_data) {
     gtk_widget_set_tooltip_text(data->loop_toggle, "Liste Sonunda Başa Dön");
     gtk_box_pack_end(GTK_BOX(controls_box), data->loop_toggle, FALSE, FALSE, 0);
 
+    // Karışık çalma ve parçayı tekrarlama
+    GtkWidget *shuffle_toggle = gtk_toggle_button_new_with_label(" Karıştır ");
+    gtk_button_set_image(GTK_BUTTON(shuffle_toggle),
+                         gtk_image_new_from_icon_name("media-playlist-shuffle-symbolic", GTK_ICON_SIZE_BUTTON));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(shuffle_toggle), data->queue.shuffle);
+    g_signal_connect(shuffle_toggle, "toggled", G_CALLBACK(on_shuffle_toggled), data);
+    gtk_widget_set_tooltip_text(shuffle_toggle, "Parçaları Tekrarsız Rastgele Sırayla Çal");
+    gtk_box_pack_end(GTK_BOX(controls_box), shuffle_toggle, FALSE, FALSE, 0);
+
+    GtkWidget *repeat_one_toggle = gtk_toggle_button_new_with_label(" Tekrarla ");
+    gtk_button_set_image(GTK_BUTTON(repeat_one_toggle),
+                         gtk_image_new_from_icon_name("media-playlist-repeat-song-symbolic", GTK_ICON_SIZE_BUTTON));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(repeat_one_toggle), data->queue.repeat_one);
+    g_signal_connect(repeat_one_toggle, "toggled", G_CALLBACK(on_repeat_one_toggled), data);
+    gtk_widget_set_tooltip_text(repeat_one_toggle, "Çalan Parça Bitince Baştan Çal");
+    gtk_box_pack_end(GTK_BOX(controls_box), repeat_one_toggle, FALSE, FALSE, 0);
+
+    // Boşluksuz geçiş toggle butonu (varsayılan: açık)
+    data->gapless_toggle = gtk_toggle_button_new_with_label(" Boşluksuz ");
+    gtk_button_set_image(GTK_BUTTON(data->gapless_toggle),
+                         gtk_image_new_from_icon_name("media-playlist-consecutive-symbolic", GTK_ICON_SIZE_BUTTON));
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(data->gapless_toggle), data->gapless_enabled);
+    g_signal_connect(data->gapless_toggle, "toggled", G_CALLBACK(on_gapless_toggled), data);
+    gtk_widget_set_tooltip_text(data->gapless_toggle, "Parçalar Arasında Boşluksuz Geçiş");
+    gtk_box_pack_end(GTK_BOX(controls_box), data->gapless_toggle, FALSE, FALSE, 0);
+
+    // Geçiş (crossfade) toggle butonu ve süresi (saniye)
+    data->crossfade_spin = gtk_spin_button_new_with_range(1, 12, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(data->crossfade_spin), CROSSFADE_DEFAULT / GST_SECOND);
+    gtk_widget_set_tooltip_text(data->crossfade_spin, "Geçiş Süresi (sn)");
+    gtk_box_pack_end(GTK_BOX(controls_box), data->crossfade_spin, FALSE, FALSE, 0);
+
+    data->crossfade_toggle = gtk_toggle_button_new_with_label(" Geçiş ");
+    gtk_button_set_image(GTK_BUTTON(data->crossfade_toggle),
+                         gtk_image_new_from_icon_name("media-playlist-shuffle-symbolic", GTK_ICON_SIZE_BUTTON));
+    gtk_widget_set_tooltip_text(data->crossfade_toggle, "Parçalar Arasında Sesi Karıştırarak Geç");
+    gtk_box_pack_end(GTK_BOX(controls_box), data->crossfade_toggle, FALSE, FALSE, 0);
+
+    g_signal_connect(data->crossfade_toggle, "toggled", G_CALLBACK(on_crossfade_changed), data);
+    g_signal_connect(data->crossfade_spin, "value-changed", G_CALLBACK(on_crossfade_changed), data);
+
     // Şu an çalan
     data->current_label = gtk_label_new("Şu an çalan: Yok");
     gtk_box_pack_start(GTK_BOX(main_box), data->current_label, FALSE, FALSE, 0);
@@ -449,7 +6270,13 @@ static void activate(GtkApplication *app, gpointer user_data) {
     // Slider
     data->slider = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 100, 1);
     gtk_scale_set_draw_value(GTK_SCALE(data->slider), FALSE);
-    g_signal_connect(data->slider, "value-changed", G_CALLBACK(seek_to_position), data);
+    // Yalnızca kullanıcı hareketleri seek üretir (change-value programatik değişimlerde çağrılmaz)
+    g_signal_connect(data->slider, "change-value", G_CALLBACK(on_slider_change_value), data);
+    g_signal_connect(data->slider, "button-press-event", G_CALLBACK(on_slider_button_press), data);
+    g_signal_connect(data->slider, "button-release-event", G_CALLBACK(on_slider_button_release), data);
+    // Dalga formu slider'dan önce, arkaplan olarak çizilir
+    gtk_widget_set_size_request(data->slider, -1, 48);
+    g_signal_connect(data->slider, "draw", G_CALLBACK(on_slider_draw), data);
     gtk_box_pack_start(GTK_BOX(slider_box), data->slider, TRUE, TRUE, 0);
 
     // Sayaç
@@ -460,25 +6287,101 @@ static void activate(GtkApplication *app, gpointer user_data) {
     GtkWidget *playlist_frame = gtk_frame_new("Oynatma Listesi");
     gtk_box_pack_start(GTK_BOX(main_box), playlist_frame, TRUE, TRUE, 5);
 
+    GtkWidget *playlist_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    gtk_container_add(GTK_CONTAINER(playlist_frame), playlist_box);
+
+    // Yazdıkça süzen arama kutusu; Enter ilk sonucu çalar
+    data->search_entry = gtk_search_entry_new();
+    gtk_entry_set_placeholder_text(GTK_ENTRY(data->search_entry), "Ara (sanatçı, başlık, dosya adı)");
+    g_signal_connect(data->search_entry, "search-changed", G_CALLBACK(on_search_changed), data);
+    g_signal_connect(data->search_entry, "activate", G_CALLBACK(on_search_activate), data);
+    gtk_box_pack_start(GTK_BOX(playlist_box), data->search_entry, FALSE, FALSE, 0);
+
     // Scrollable window
     GtkWidget *scrolled_window = gtk_scrolled_window_new(NULL, NULL);
-    gtk_container_add(GTK_CONTAINER(playlist_frame), scrolled_window);
+    gtk_box_pack_start(GTK_BOX(playlist_box), scrolled_window, TRUE, TRUE, 0);
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrolled_window),
                                    GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
 
-    // Playlist için GtkListBox
-    data->playlist_box = gtk_list_box_new();
-    gtk_container_add(GTK_CONTAINER(scrolled_window), data->playlist_box);
+    // Playlist için sanal modelli GtkTreeView
+    data->playlist_model = g_object_new(PLAYLIST_TYPE_MODEL, NULL);
+    data->playlist_model->data = data;
+    data->playlist_model->shown = playlist_store_count(data->playlist);
+    data->playlist_model->revision = data->playlist->revision;
+    data->playlist_view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(data->playlist_model));
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(data->playlist_view), FALSE);
+
+    // Tek sütun: ikon + dosya adı. Çalan satırın arkaplanı modelden gelir.
+    GtkTreeViewColumn *column = gtk_tree_view_column_new();
+    gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_expand(column, TRUE);
+
+    GtkCellRenderer *icon_renderer = gtk_cell_renderer_pixbuf_new();
+    g_object_set(icon_renderer, "xpad", 6, NULL);
+    gtk_tree_view_column_pack_start(column, icon_renderer, FALSE);
+    gtk_tree_view_column_add_attribute(column, icon_renderer, "icon-name", PLAYLIST_COL_ICON);
+    gtk_tree_view_column_add_attribute(column, icon_renderer, "cell-background", PLAYLIST_COL_BACKGROUND);
+
+    GtkCellRenderer *text_renderer = gtk_cell_renderer_text_new();
+    g_object_set(text_renderer, "xpad", 6, NULL);
+    gtk_tree_view_column_pack_start(column, text_renderer, TRUE);
+    gtk_tree_view_column_add_attribute(column, text_renderer, "text", PLAYLIST_COL_NAME);
+    gtk_tree_view_column_add_attribute(column, text_renderer, "cell-background", PLAYLIST_COL_BACKGROUND);
+
+    gtk_tree_view_append_column(GTK_TREE_VIEW(data->playlist_view), column);
+
+    // Süre sütunu (taranan parçalar için)
+    GtkTreeViewColumn *duration_column = gtk_tree_view_column_new();
+    gtk_tree_view_column_set_sizing(duration_column, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(duration_column, 70);
+
+    GtkCellRenderer *duration_renderer = gtk_cell_renderer_text_new();
+    g_object_set(duration_renderer, "xalign", 1.0, "xpad", 6, NULL);
+    gtk_tree_view_column_pack_start(duration_column, duration_renderer, TRUE);
+    gtk_tree_view_column_add_attribute(duration_column, duration_renderer, "text", PLAYLIST_COL_DURATION);
+    gtk_tree_view_column_add_attribute(duration_column, duration_renderer, "cell-background", PLAYLIST_COL_BACKGROUND);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(data->playlist_view), duration_column);
+
+    // Sabit satır yüksekliği: satırlar tek tek ölçülmez, büyük listelerde hızlıdır
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(data->playlist_view), TRUE);
+    gtk_container_add(GTK_CONTAINER(scrolled_window), data->playlist_view);
 
     // Satıra çift tık / Enter (row-activated) yapıldığında şarkıyı çalsın
-    g_signal_connect(data->playlist_box, "row-activated",
+    g_signal_connect(data->playlist_view, "row-activated",
                      G_CALLBACK(on_playlist_row_activated), data);
 
+    // Sağ tık: sıradaki olarak çal / sıraya ekle
+    data->queue_menu = gtk_menu_new();
+    GtkWidget *play_next_item = gtk_menu_item_new_with_label("Sıradaki Olarak Çal");
+    g_signal_connect(play_next_item, "activate", G_CALLBACK(on_queue_play_next), data);
+    gtk_menu_shell_append(GTK_MENU_SHELL(data->queue_menu), play_next_item);
+    GtkWidget *queue_add_item = gtk_menu_item_new_with_label("Sıraya Ekle");
+    g_signal_connect(queue_add_item, "activate", G_CALLBACK(on_queue_add), data);
+    gtk_menu_shell_append(GTK_MENU_SHELL(data->queue_menu), queue_add_item);
+    gtk_widget_show_all(data->queue_menu);
+    gtk_menu_attach_to_widget(GTK_MENU(data->queue_menu), data->playlist_view, NULL);
+    g_signal_connect(data->playlist_view, "button-press-event", G_CALLBACK(on_playlist_button_press), data);
+
+    // İsteğe bağlı istatistik paneli; kapalıyken ölçümler örneklenmez
+    data->stats_expander = gtk_expander_new("İstatistikler");
+    gtk_box_pack_start(GTK_BOX(main_box), data->stats_expander, FALSE, FALSE, 0);
+
+    GtkWidget *stats_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 6);
+    gtk_container_add(GTK_CONTAINER(data->stats_expander), stats_box);
+
+    data->stats_label = gtk_label_new(NULL);
+    gtk_label_set_xalign(GTK_LABEL(data->stats_label), 0.0);
+    gtk_box_pack_start(GTK_BOX(stats_box), data->stats_label, TRUE, TRUE, 0);
+
+    GtkWidget *stats_log_toggle = gtk_toggle_button_new_with_label(" Kaydet ");
+    gtk_widget_set_valign(stats_log_toggle, GTK_ALIGN_START);
+    g_signal_connect(stats_log_toggle, "toggled", G_CALLBACK(on_stats_log_toggled), data);
+    gtk_box_pack_start(GTK_BOX(stats_box), stats_log_toggle, FALSE, FALSE, 0);
+
     /*
      * Basit bir CSS ile:
      *  1) Arkaplan ve yazı rengi
-     *  2) Seçili satırın rengi
-     *  3) Frame (liste çerçevesi) rengi, vs.
+     *  2) Frame (liste çerçevesi) rengi, vs.
      */
     GtkCssProvider *provider = gtk_css_provider_new();
     gtk_css_provider_load_from_data(provider,
@@ -486,10 +6389,6 @@ static void activate(GtkApplication *app, gpointer user_data) {
         "   background-color: #f8f8f8;"
         "   color: #333;"
         "}"
-        ".selected-row {"
-        "   background-color: #d0e0ff;"
-        "   border-radius: 4px;"
-        "}"
         "frame {"
         "   background-color: #fafafa;"
         "   border: 1px solid #ccc;"
@@ -499,11 +6398,907 @@ static void activate(GtkApplication *app, gpointer user_data) {
     gtk_style_context_add_provider_for_screen(
         gdk_screen_get_default(),
         GTK_STYLE_PROVIDER(provider),
-        GTK_STYLE_PROVIDER_PRIORITY_APPLICATIO
+        GTK_STYLE_PROVIDER_PRIORITY_APPLICATION
     );
     g_object_unref(provider);
+}
 
-    gtk_widget_show_all(window);
+/*
+ * ---- Headless mod ----
+ * GTK başlatılmadan yalnızca çalma çekirdeği çalışır. Parçalar komut
+ * satırından (dosya ya da klasör) veya stdin'den (satır başına bir yol)
+ * alınır. Kontrol, satır tabanlı komutlar kabul eden bir Unix soketinden
+ * yapılır:
+ *   play | pause | toggle | stop | next | previous | seek <sn> |
+ *   goto <indeks> | add <mutlak yol> | crossfade <sn> (0: kapalı) | analyze |
+ *   normalize on|off | status | stats | quit
+ */
+
+typedef struct {
+    PlayerData       *data;
+    GSocketConnection *connection;
+    GDataInputStream *input;
+    GOutputStream    *output;
+} ControlClient;
+
+static void control_read_line(ControlClient *client);
+
+/* İndeksteki parçayı yükler ve çalar */
+static void player_play_index(PlayerData *data, int index) {
+    if (index < 0 || index >= playlist_store_count(data->playlist))
+        return;
+
+    stop_media(data);
+    data->current_index = index;
+
+    if (player_load(data, index)) {
+        play_media(data);
+    }
+    update_labels_and_buttons(data);
+}
+
+/* Tek bir kontrol komutunu çalıştırır, istemciye gönderilecek cevabı döndürür */
+static gchar *control_execute(PlayerData *data, const gchar *line) {
+    gchar **argv = g_strsplit(line, " ", 2);
+    const gchar *command = argv[0] ? argv[0] : "";
+    const gchar *arg = argv[0] && argv[1] ? g_strstrip(argv[1]) : NULL;
+    gchar *reply = NULL;
+
+    if (g_str_equal(command, "play")) {
+        if (!data->is_playing)
+            play_media(data);
+    } else if (g_str_equal(command, "pause")) {
+        if (data->is_playing)
+            play_media(data);
+    } else if (g_str_equal(command, "toggle")) {
+        play_media(data);
+    } else if (g_str_equal(command, "stop")) {
+        stop_media(data);
+    } else if (g_str_equal(command, "next")) {
+        next_media(data);
+    } else if (g_str_equal(command, "previous") || g_str_equal(command, "prev")) {
+        previous_media(data);
+    } else if ((g_str_equal(command, "queue") || g_str_equal(command, "playnext")) && arg) {
+        int index = (int)g_ascii_strtoll(arg, NULL, 10);
+        if (index >= 0 && index < playlist_store_count(data->playlist)) {
+            play_queue_add(data, index, g_str_equal(command, "playnext"));
+        } else {
+            reply = g_strdup("ERR geçersiz indeks\n");
+        }
+    } else if (g_str_equal(command, "shuffle") && arg) {
+        player_set_shuffle(data, g_str_equal(arg, "on"));
+    } else if (g_str_equal(command, "repeat") && arg) {
+        // repeat one | all | off
+        player_set_repeat_one(data, g_str_equal(arg, "one"));
+        data->loop_enabled = g_str_equal(arg, "all");
+        prepare_gapless_next(data);
+    } else if (g_str_equal(command, "seek") && arg) {
+        seek_to_position(data, g_ascii_strtod(arg, NULL), GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE);
+    } else if (g_str_equal(command, "goto") && arg) {
+        int index = (int)g_ascii_strtoll(arg, NULL, 10);
+        if (index >= 0 && index < playlist_store_count(data->playlist)) {
+            player_play_index(data, index);
+        } else {
+            reply = g_strdup("ERR geçersiz indeks\n");
+        }
+    } else if (g_str_equal(command, "add") && arg && !g_path_is_absolute(arg)) {
+        // Göreli yol istemcinin değil sunucunun klasörüne göre çözülürdü
+        reply = g_strdup("ERR mutlak yol gerekli\n");
+    } else if (g_str_equal(command, "add") && arg) {
+        gboolean was_empty = playlist_store_count(data->playlist) == 0;
+        playlist_store_append(data->playlist, arg, NULL, NULL, GST_CLOCK_TIME_NONE);
+        if (was_empty) {
+            player_play_index(data, 0);
+        } else {
+            prepare_gapless_next(data);
+        }
+    } else if (g_str_equal(command, "crossfade") && arg) {
+        gdouble seconds = g_ascii_strtod(arg, NULL);
+        player_set_crossfade(data, seconds > 0, seconds);
+        if (seconds > 0 && !data->crossfade_enabled) {
+            reply = g_strdup("ERR geçiş modu başlatılamadı\n");
+        }
+    } else if (g_str_equal(command, "analyze")) {
+        loudness_analysis_start(data);
+    } else if (g_str_equal(command, "duplicates")) {
+        duplicate_analysis_start(data);
+    } else if (g_str_equal(command, "dedupe")) {
+        reply = g_strdup_printf("OK removed=%d\n", duplicates_collapse(data));
+    } else if (g_str_equal(command, "normalize") && arg) {
+        data->normalize_enabled = g_str_equal(arg, "on");
+        player_apply_gain(data);
+    } else if (g_str_equal(command, "eq") && arg) {
+        int preset = equalizer_preset_find(arg);
+        if (preset >= 0) {
+            player_set_equalizer(data, preset);
+        } else {
+            reply = g_strdup_printf("ERR bilinmeyen ön ayar: %s\n", arg);
+        }
+    } else if (g_str_equal(command, "status")) {
+        gint64 position = -1;
+        int count = playlist_store_count(data->playlist);
+        player_query_position(data, &position);
+        g_mutex_lock(&data->prefetch_lock);
+        guint64 hits = data->prefetch_hits, misses = data->prefetch_misses;
+        g_mutex_unlock(&data->prefetch_lock);
+        reply = g_strdup_printf("OK state=%s index=%d count=%d position=%.1f"
+                                " prefetch_hits=%" G_GUINT64_FORMAT " prefetch_misses=%" G_GUINT64_FORMAT
+                                " shuffle=%s repeat=%s queued=%u eq=%s file=%s\n",
+                                data->is_playing ? "playing" : "paused",
+                                data->current_index, count,
+                                position >= 0 ? (gdouble)position / GST_SECOND : 0.0,
+                                hits, misses, data->queue.shuffle ? "on" : "off",
+                                data->queue.repeat_one ? "one" : data->loop_enabled ? "all" : "off",
+                                g_queue_get_length(&data->queue.upcoming),
+                                eq_presets[g_atomic_int_get(&data->eq_preset)].name,
+                                count > 0 ? playlist_store_path(data->playlist, data->current_index) : "");
+    } else if (g_str_equal(command, "stats")) {
+        gchar *json = stats_to_json(data);
+        reply = g_strdup_printf("OK %s\n", json);
+        g_free(json);
+    } else if (g_str_equal(command, "quit")) {
+        g_main_loop_quit(data->main_loop);
+    } else {
+        reply = g_strdup_printf("ERR bilinmeyen komut: %s\n", command);
+    }
+
+    g_strfreev(argv);
+    return reply ? reply : g_strdup("OK\n");
+}
+
+static void control_client_free(ControlClient *client) {
+    g_object_unref(client->input);
+    g_object_unref(client->connection);
+    g_free(client);
+}
+
+static void control_line_ready(GObject *source, GAsyncResult *result, gpointer user_data) {
+    ControlClient *client = user_data;
+    gchar *line = g_data_input_stream_read_line_finish(client->input, result, NULL, NULL);
+
+    // Bağlantı kapandı
+    if (!line) {
+        control_client_free(client);
+        return;
+    }
+
+    gchar *reply = control_execute(client->data, g_strstrip(line));
+    gboolean written = g_output_stream_write_all(client->output, reply, strlen(reply),
+                                                 NULL, NULL, NULL);
+    g_free(reply);
+    g_free(line);
+
+    if (written) {
+        control_read_line(client);
+    } else {
+        control_client_free(client);
+    }
+}
+
+static void control_read_line(ControlClient *client) {
+    g_data_input_stream_read_line_async(client->input, G_PRIORITY_DEFAULT, NULL,
+                                        control_line_ready, client);
+}
+
+/* Sokete yeni bir istemci bağlandığında çağrılır */
+static gboolean on_control_incoming(GSocketService *service, GSocketConnection *connection,
+                                    GObject *source_object, gpointer user_data) {
+    ControlClient *client = g_new0(ControlClient, 1);
+
+    client->data = (PlayerData *)user_data;
+    client->connection = g_object_ref(connection);
+    client->input = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+    client->output = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+    control_read_line(client);
+    return TRUE;
+}
+
+/*
+ * Yolda önceki çalıştırmadan kalan bayat bir soket varsa siler. Yol soket
+ * değilse ya da soketi dinleyen başka bir örnek varsa dokunmaz ve FALSE
+ * döner.
+ */
+static gboolean control_remove_stale(const gchar *path, GSocketAddress *address) {
+    GStatBuf st;
+
+    if (g_lstat(path, &st) != 0)
+        return TRUE;
+    if (!S_ISSOCK(st.st_mode)) {
+        g_printerr("Hata: %s bir soket değil, üzerine yazılmadı.\n", path);
+        return FALSE;
+    }
+
+    GSocketClient *client = g_socket_client_new();
+    GSocketConnection *connection = g_socket_client_connect(client, G_SOCKET_CONNECTABLE(address),
+                                                            NULL, NULL);
+    g_object_unref(client);
+    if (connection) {
+        g_printerr("Hata: %s başka bir örnek tarafından kullanılıyor.\n", path);
+        g_object_unref(connection);
+        return FALSE;
+    }
+    g_unlink(path);
+    return TRUE;
+}
+
+/* Unix soket kontrol arayüzünü başlatır */
+static gboolean control_start(PlayerData *data, const gchar *path) {
+    GError *err = NULL;
+    GSocketAddress *address = g_unix_socket_address_new(path);
+
+    if (!control_remove_stale(path, address)) {
+        g_object_unref(address);
+        return FALSE;
+    }
+    data->control_service = g_socket_service_new();
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(data->control_service), address,
+                                       G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT,
+                                       NULL, NULL, &err)) {
+        g_printerr("Hata: Kontrol soketi açılamadı (%s): %s\n", path, err->message);
+        g_error_free(err);
+        g_object_unref(address);
+        g_clear_object(&data->control_service);
+        return FALSE;
+    }
+    g_object_unref(address);
+
+    data->control_path = g_strdup(path);
+    g_signal_connect(data->control_service, "incoming", G_CALLBACK(on_control_incoming), data);
+    g_socket_service_start(data->control_service);
+    g_print("Kontrol soketi: %s\n", path);
+    return TRUE;
+}
+
+static gboolean on_headless_signal(gpointer user_data) {
+    PlayerData *data = (PlayerData *)user_data;
+    g_main_loop_quit(data->main_loop);
+    return G_SOURCE_CONTINUE;
+}
+
+/* stdin'den satır başına bir yol okur (göreli yollar çalışma klasörüne göre) */
+static void headless_read_stdin(PlayerData *data) {
+    char line[4096];
+
+    while (fgets(line, sizeof(line), stdin)) {
+        g_strstrip(line);
+        if (*line) {
+            gchar *path = g_canonicalize_filename(line, NULL);
+            playlist_store_append(data->playlist, path, NULL, NULL, GST_CLOCK_TIME_NONE);
+            g_free(path);
+        }
+    }
+}
+
+/*
+ * mp3_player --headless [--socket YOL] [--crossfade SN] [--stats-log DOSYA] [--eq ÖNAYAR]
+ *                       [dosya|klasör|-]...
+ * Argüman verilmezse ve stdin bir terminal değilse yollar stdin'den okunur.
+ * --stats-log: ölçümler saniyede bir eklenir (.csv ise CSV, değilse JSON satırları).
+ * --eq: ekolayzer ön ayarı (flat, bass, vocal, treble, loudness).
+ */
+static int run_headless(int argc, char **argv) {
+    PlayerData *data = player_new("autoaudiosink");
+    if (!data)
+        return 1;
+
+    gchar *socket_path = NULL;
+    GPtrArray *folders = g_ptr_array_new();
+    gboolean read_stdin = argc == 0 && !isatty(STDIN_FILENO);
+
+    for (int i = 0; i < argc; i++) {
+        if (g_str_equal(argv[i], "--socket") && i + 1 < argc) {
+            socket_path = g_strdup(argv[++i]);
+        } else if (g_str_equal(argv[i], "--crossfade") && i + 1 < argc) {
+            gdouble seconds = g_ascii_strtod(argv[++i], NULL);
+            player_set_crossfade(data, seconds > 0, seconds);
+        } else if (g_str_equal(argv[i], "--stats-log") && i + 1 < argc) {
+            stats_log_open(data, argv[++i]);
+        } else if (g_str_equal(argv[i], "--eq") && i + 1 < argc) {
+            player_set_equalizer(data, equalizer_preset_find(argv[++i]));
+        } else if (g_str_equal(argv[i], "-")) {
+            read_stdin = TRUE;
+        } else if (g_file_test(argv[i], G_FILE_TEST_IS_DIR)) {
+            g_ptr_array_add(folders, g_canonicalize_filename(argv[i], NULL));
+        } else {
+            // URI'ye çevrilebilmesi için yollar mutlak tutulur
+            gchar *path = g_canonicalize_filename(argv[i], NULL);
+            playlist_store_append(data->playlist, path, NULL, NULL, GST_CLOCK_TIME_NONE);
+            g_free(path);
+        }
+    }
+    if (read_stdin) {
+        headless_read_stdin(data);
+    }
+
+    data->main_loop = g_main_loop_new(NULL, FALSE);
+    g_unix_signal_add(SIGINT, on_headless_signal, data);
+    g_unix_signal_add(SIGTERM, on_headless_signal, data);
+
+    if (!socket_path) {
+        socket_path = g_build_filename(g_get_user_runtime_dir(), "mp3_player.sock", NULL);
+    }
+    control_start(data, socket_path);
+    g_free(socket_path);
+
+    // Klasörler arkaplanda taranır, parçalar geldikçe listeye eklenir
+    if (folders->len > 0) {
+        g_ptr_array_add(folders, NULL);
+        library_scan_start(data, (gchar **)g_ptr_array_free(folders, FALSE));
+    } else {
+        g_ptr_array_free(folders, TRUE);
+    }
+
+    // Dosya verilmediyse son oturumdan devam edilir
+    if (argc == 0 && playlist_store_count(data->playlist) == 0 && session_restore(data))
+        player_set_state(data, GST_STATE_PLAYING);
+    else
+        player_play_index(data, 0);
+    g_main_loop_run(data->main_loop);
+
+    session_store(data);
+    stop_media(data);
+    player_control_shutdown(data);
+    stats_log_close(data);
+    if (data->control_path) {
+        g_socket_service_stop(data->control_service);
+        g_unlink(data->control_path);
+    }
+    gst_element_set_state(data->playbin, GST_STATE_NULL);
+    gst_object_unref(data->playbin);
+    return 0;
+}
+
+/*
+ * ---- Benchmark ----
+ * mp3_player --bench [--sizes 1000,10000,100000] [--sink fakesink] [--output DOSYA]
+ *
+ * Çalma çekirdeğini sentetik playlistlerle sürer ve sonuçları JSON olarak
+ * yazar. Playlist girdileri geçici klasörde üretilen kısa WAV dosyalarına
+ * işaret eder. Ekran varsa (gtk_init_check) arayüz de kurulur ve
+ * playlist/etiket güncellemeleri ölçülür; yoksa bu alanlar null olur.
+ */
+
+#define BENCH_AUDIO_FILES  8    // Üretilen farklı ses dosyası sayısı
+#define BENCH_ITERATIONS   20   // Gecikme ölçümlerinde tekrar sayısı
+#define BENCH_TIMEOUT_MS   5000 // Tek bir ölçüm için bekleme sınırı
+#define BENCH_SKIP_STORM   10   // Art arda "sonraki" basışı sayısı
+#define BENCH_QUEUE_STEPS  10000 // Karışık çalmada ölçülen en fazla adım
+
+enum {
+    BENCH_PROBE_IDLE,        // Ölçüm yok
+    BENCH_PROBE_WAIT_STREAM_START, // Yeni parçanın STREAM_START'ı bekleniyor
+    BENCH_PROBE_WAIT_FLUSH,  // Seek'in FLUSH_STOP'u bekleniyor
+    BENCH_PROBE_WAIT_BUFFER, // İlk buffer bekleniyor
+    BENCH_PROBE_DONE         // hit_time dolu
+};
+
+/* Sink pad'indeki ilk buffer'ın geliş anını yakalar */
+typedef struct {
+    gint   state;
+    gint64 hit_time; // g_get_monotonic_time(), µs
+} BenchProbe;
+
+static GstPadProbeReturn bench_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    BenchProbe *probe = user_data;
+    gint state = g_atomic_int_get(&probe->state);
+
+    if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+        GstEventType type = GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info));
+        // Eski parçanın hâlâ akan buffer'ları sayılmasın
+        if ((state == BENCH_PROBE_WAIT_FLUSH && type == GST_EVENT_FLUSH_STOP) ||
+            (state == BENCH_PROBE_WAIT_STREAM_START && type == GST_EVENT_STREAM_START)) {
+            g_atomic_int_set(&probe->state, BENCH_PROBE_WAIT_BUFFER);
+        }
+    } else if (state == BENCH_PROBE_WAIT_BUFFER) {
+        probe->hit_time = g_get_monotonic_time();
+        g_atomic_int_set(&probe->state, BENCH_PROBE_DONE);
+        g_main_context_wakeup(NULL);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+static gboolean bench_timeout_cb(gpointer user_data) {
+    *(gboolean *)user_data = TRUE;
+    return G_SOURCE_REMOVE;
+}
+
+/* Probe tetiklenene kadar ana döngüyü çalıştırır; başlangıçtan geçen süreyi (ms) döndürür */
+static gdouble bench_wait_probe(BenchProbe *probe, gint64 start) {
+    gboolean timed_out = FALSE;
+    guint timeout_id = g_timeout_add(BENCH_TIMEOUT_MS, bench_timeout_cb, &timed_out);
+
+    while (g_atomic_int_get(&probe->state) != BENCH_PROBE_DONE && !timed_out) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+    if (!timed_out)
+        g_source_remove(timeout_id);
+
+    g_atomic_int_set(&probe->state, BENCH_PROBE_IDLE);
+    return timed_out ? -1.0 : (probe->hit_time - start) / 1000.0;
+}
+
+/* Bekleyen GTK olaylarını (layout, çizim) işler */
+static void bench_pump_events(void) {
+    while (g_main_context_iteration(NULL, FALSE))
+        ;
+}
+
+/* 2 sn'lik mono 16 bit 44.1 kHz sinüs WAV dosyası yazar */
+static gboolean bench_write_wav(const gchar *path, gdouble frequency) {
+    const guint32 rate = 44100, samples = rate * 2;
+    const guint32 data_size = samples * 2;
+    guint8 *wav = g_malloc(44 + data_size);
+    guint8 *p = wav;
+
+#define PUT32(v) do { guint32 _v = (v); memcpy(p, &_v, 4); p += 4; } while (0)
+#define PUT16(v) do { guint16 _v = (v); memcpy(p, &_v, 2); p += 2; } while (0)
+    memcpy(p, "RIFF", 4); p += 4; PUT32(36 + data_size);
+    memcpy(p, "WAVEfmt ", 8); p += 8; PUT32(16);
+    PUT16(1); PUT16(1); PUT32(rate); PUT32(rate * 2); PUT16(2); PUT16(16);
+    memcpy(p, "data", 4); p += 4; PUT32(data_size);
+    for (guint32 i = 0; i < samples; i++) {
+        PUT16((guint16)(gint16)(8000.0 * sin(2.0 * G_PI * frequency * i / rate)));
+    }
+#undef PUT32
+#undef PUT16
+
+    gboolean ok = g_file_set_contents(path, (const gchar *)wav, 44 + data_size, NULL);
+    g_free(wav);
+    return ok;
+}
+
+static gint bench_compare_double(gconstpointer a, gconstpointer b) {
+    gdouble x = *(const gdouble *)a, y = *(const gdouble *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Ölçüm dizisini {"mean","p50","p95","max"} olarak yazar; ölçüm yoksa null */
+static void bench_append_stats(GString *out, const gchar *name, GArray *samples) {
+    g_string_append_printf(out, "\"%s\": ", name);
+    if (samples->len == 0) {
+        g_string_append(out, "null");
+        return;
+    }
+
+    gdouble sum = 0;
+    g_array_sort(samples, bench_compare_double);
+    for (guint i = 0; i < samples->len; i++) {
+        sum += g_array_index(samples, gdouble, i);
+    }
+    g_string_append_printf(out, "{\"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"max\": %.3f, \"n\": %u}",
+                           sum / samples->len,
+                           g_array_index(samples, gdouble, samples->len / 2),
+                           g_array_index(samples, gdouble, (samples->len * 95) / 100),
+                           g_array_index(samples, gdouble, samples->len - 1),
+                           samples->len);
+}
+
+static void bench_append_ms(GString *out, const gchar *name, gdouble value) {
+    if (value < 0) {
+        g_string_append_printf(out, "\"%s\": null", name);
+    } else {
+        g_string_append_printf(out, "\"%s\": %.3f", name, value);
+    }
+}
+
+static glong bench_peak_rss_kb(void) {
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+}
+
+static void bench_silent_print(G_GNUC_UNUSED const gchar *string) {
+}
+
+/* Tek bir playlist boyutu için tüm ölçümleri yapar ve JSON nesnesini ekler */
+static void bench_run_size(PlayerData *data, BenchProbe *probe, gchar **audio_files,
+                           int entries, GString *out) {
+    GArray *next_latency = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    GArray *seek_latency = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    GArray *search_latency = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    GArray *storm_latency = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    gdouble refresh_ms = -1, track_change_ms = -1;
+    GSList *files = NULL;
+
+    stop_media(data);
+
+    // Sentetik liste (ölçüme dahil değil)
+    for (int i = entries - 1; i >= 0; i--) {
+        files = g_slist_prepend(files, g_strdup(audio_files[i % BENCH_AUDIO_FILES]));
+    }
+
+    // file_chosen tarzı liste yükleme (görünüm yenilemesi hariç)
+    GtkWidget *view = data->playlist_view;
+    data->playlist_view = NULL;
+    gint64 start = g_get_monotonic_time();
+    playlist_replace(data, files);
+    gdouble load_ms = (g_get_monotonic_time() - start) / 1000.0;
+    data->playlist_view = view;
+    g_slist_free_full(files, g_free);
+
+    if (data->window) {
+        // Yeni listenin görünüme bağlanması ve çizilmesi
+        start = g_get_monotonic_time();
+        refresh_playlist(data);
+        bench_pump_events();
+        refresh_ms = (g_get_monotonic_time() - start) / 1000.0;
+
+        // Parça değişiminde etiket ve vurgu güncellemesi (çalmadan)
+        start = g_get_monotonic_time();
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            data->current_index = (i * 7919) % entries;
+            update_labels_and_buttons(data);
+            bench_pump_events();
+        }
+        track_change_ms = (g_get_monotonic_time() - start) / 1000.0 / BENCH_ITERATIONS;
+        data->current_index = 0;
+    }
+
+    // Arama indeksinin kurulması ve tuş başına süzme (GTK varsa görünüm yenilemesiyle)
+    if (!data->search_index) {
+        data->search_index = search_index_new();
+        data->search_results = g_array_new(FALSE, FALSE, sizeof(guint32));
+    }
+    start = g_get_monotonic_time();
+    search_index_update(data->search_index, data->playlist);
+    gdouble search_index_ms = (g_get_monotonic_time() - start) / 1000.0;
+
+    static const gchar bench_query[] = "track05";
+    for (int round = 0; round < BENCH_ITERATIONS; round++) {
+        for (gsize len = 1; len <= strlen(bench_query); len++) {
+            gchar *prefix = g_strndup(bench_query, len);
+            start = g_get_monotonic_time();
+            if (data->search_entry) {
+                gtk_entry_set_text(GTK_ENTRY(data->search_entry), prefix);
+                refresh_playlist(data);
+                bench_pump_events();
+            } else {
+                search_index_query(data->search_index, data->playlist, prefix, data->search_results);
+            }
+            gdouble ms = (g_get_monotonic_time() - start) / 1000.0;
+            g_array_append_val(search_latency, ms);
+            g_free(prefix);
+        }
+    }
+    guint search_matches = data->search_results->len;
+    if (data->search_entry) {
+        gtk_entry_set_text(GTK_ENTRY(data->search_entry), "");
+        refresh_playlist(data);
+    }
+
+    // İlk parçayı başlat; kısa parçalar ölçüm sırasında bitip kendiliğinden geçiş yapmasın
+    data->hold_on_eos = TRUE;
+    g_atomic_int_set(&probe->state, BENCH_PROBE_WAIT_STREAM_START);
+    player_play_index(data, 0);
+    bench_wait_probe(probe, g_get_monotonic_time());
+
+    guint64 seeks_before = data->seek_count;
+    g_mutex_lock(&data->prefetch_lock);
+    guint64 hits_before = data->prefetch_hits, misses_before = data->prefetch_misses;
+    g_mutex_unlock(&data->prefetch_lock);
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        // next_media -> sink'e yeni parçanın ilk buffer'ı
+        g_atomic_int_set(&probe->state, BENCH_PROBE_WAIT_STREAM_START);
+        start = g_get_monotonic_time();
+        next_media(data);
+        gdouble ms = bench_wait_probe(probe, start);
+        if (ms >= 0)
+            g_array_append_val(next_latency, ms);
+
+        // seek -> sink'e seek sonrası ilk buffer
+        player_control_sync(data);
+        gst_element_get_state(data->pipeline, NULL, NULL, BENCH_TIMEOUT_MS * GST_MSECOND);
+        g_atomic_int_set(&probe->state, BENCH_PROBE_WAIT_FLUSH);
+        start = g_get_monotonic_time();
+        seek_to_position(data, 1.0, GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE);
+        ms = bench_wait_probe(probe, start);
+        if (ms >= 0)
+            g_array_append_val(seek_latency, ms);
+    }
+
+    // Art arda "sonraki" basışları: ana thread'in basış başına süresi ve birleştirilmiş geçiş sayısı
+    g_mutex_lock(&data->control.wake_lock);
+    guint executed_before = data->control.executed;
+    g_mutex_unlock(&data->control.wake_lock);
+    for (int i = 0; i < BENCH_SKIP_STORM; i++) {
+        start = g_get_monotonic_time();
+        next_media(data);
+        gdouble ms = (g_get_monotonic_time() - start) / 1000.0;
+        g_array_append_val(storm_latency, ms);
+    }
+    player_control_sync(data);
+    g_mutex_lock(&data->control.wake_lock);
+    guint storm_transitions = data->control.executed - executed_before;
+    g_mutex_unlock(&data->control.wake_lock);
+    stop_media(data);
+    data->hold_on_eos = FALSE;
+
+    // Oturumun yazılması ve geri yüklenip görünüme bağlanması
+    gchar *session_file = g_build_filename(g_get_tmp_dir(), "mp3_player-bench-session.bin", NULL);
+    GstClockTime session_position;
+    start = g_get_monotonic_time();
+    session_save(data, session_file);
+    gdouble session_save_ms = (g_get_monotonic_time() - start) / 1000.0;
+    start = g_get_monotonic_time();
+    gboolean restored = session_load(data, session_file, &session_position);
+    if (restored && data->window) {
+        refresh_playlist(data);
+        bench_pump_events();
+    }
+    gdouble session_restore_ms = restored ? (g_get_monotonic_time() - start) / 1000.0 : -1;
+    g_unlink(session_file);
+    g_free(session_file);
+
+    // Karışık çalmada sonraki/önceki seçimi (parça yüklenmeden); ilk turda tekrar olmamalı
+    int steps = MIN(entries, BENCH_QUEUE_STEPS);
+    guint8 *seen = g_new0(guint8, entries);
+    guint shuffle_repeats = 0;
+    data->current_index = 0;
+    player_set_shuffle(data, TRUE);
+    seen[0] = 1;
+    start = g_get_monotonic_time();
+    for (int i = 1; i < steps; i++) {
+        data->current_index = play_queue_peek(data, 1, FALSE);
+        shuffle_repeats += seen[data->current_index]++ > 0;
+    }
+    for (int i = 1; i < steps; i++) {
+        data->current_index = play_queue_previous(data);
+    }
+    gdouble shuffle_step_us = steps > 1 ? (g_get_monotonic_time() - start) / (2.0 * (steps - 1)) : -1;
+    player_set_shuffle(data, FALSE);
+    data->current_index = 0;
+    g_free(seen);
+
+    g_string_append_printf(out, "    {\"entries\": %d, ", entries);
+    bench_append_ms(out, "list_load_ms", load_ms);
+    g_string_append(out, ", ");
+    bench_append_ms(out, "refresh_playlist_ms", refresh_ms);
+    g_string_append(out, ", ");
+    bench_append_ms(out, "track_change_ui_ms", track_change_ms);
+    g_string_append(out, ", ");
+    bench_append_stats(out, "next_to_first_buffer_ms", next_latency);
+    g_string_append(out, ", ");
+    bench_append_stats(out, "seek_to_audio_ms", seek_latency);
+    g_string_append(out, ", ");
+    bench_append_stats(out, "skip_storm_ui_ms", storm_latency);
+    g_string_append_printf(out, ", \"skip_storm_transitions\": %u, ", storm_transitions);
+    bench_append_ms(out, "search_index_ms", search_index_ms);
+    g_string_append(out, ", ");
+    bench_append_stats(out, "search_keystroke_ms", search_latency);
+    g_string_append_printf(out, ", \"search_matches\": %u, ", search_matches);
+    bench_append_ms(out, "session_save_ms", session_save_ms);
+    g_string_append(out, ", ");
+    bench_append_ms(out, "session_restore_ms", session_restore_ms);
+    g_string_append(out, ", ");
+    bench_append_ms(out, "shuffle_step_us", shuffle_step_us);
+    g_string_append_printf(out, ", \"shuffle_repeats\": %u", shuffle_repeats);
+    g_mutex_lock(&data->prefetch_lock);
+    g_string_append_printf(out, ", \"prefetch_hits\": %" G_GUINT64_FORMAT ", \"prefetch_misses\": %" G_GUINT64_FORMAT,
+                           data->prefetch_hits - hits_before, data->prefetch_misses - misses_before);
+    g_mutex_unlock(&data->prefetch_lock);
+    g_string_append_printf(out, ", \"seeks_issued\": %" G_GUINT64_FORMAT ", \"peak_rss_kb\": %ld}",
+                           data->seek_count - seeks_before, bench_peak_rss_kb());
+
+    g_array_free(next_latency, TRUE);
+    g_array_free(seek_latency, TRUE);
+    g_array_free(search_latency, TRUE);
+    g_array_free(storm_latency, TRUE);
+}
+
+#define BENCH_EQ_FRAMES  1024 // Buffer başına çerçeve (44.1 kHz'de ~23 ms)
+#define BENCH_EQ_BUFFERS 4000
+
+/*
+ * Ekolayzer + sınırlayıcının buffer başına maliyeti (stereo, 44.1 kHz, tüm
+ * bantları açık ön ayar). Sessiz ölçümde gürültüden sonra sıfırlar süzülür;
+ * sönen filtre durumu denormallara inerse burada görünür.
+ */
+static void bench_equalizer(GString *out) {
+    gint preset = equalizer_preset_find("loudness");
+    gfloat *samples = g_new(gfloat, BENCH_EQ_FRAMES * 2);
+    gfloat *silence = g_new(gfloat, BENCH_EQ_FRAMES * 2);
+    gdouble us[2] = { -1, -1 }, silent_us[2] = { -1, -1 };
+    guint32 seed = 1;
+
+    for (int k = 0; k < BENCH_EQ_FRAMES * 2; k++) {
+        seed = seed * 1664525u + 1013904223u;
+        samples[k] = (gint32)seed / 4294967296.0f;
+    }
+    for (int simd = 0; simd < 2; simd++) {
+#ifndef __SSE__
+        if (simd)
+            break;
+#endif
+        Equalizer eq = { .preset = &preset, .applied = -1, .rate = 44100, .channels = 2, .limit_gain = 1.0f };
+        gint64 start = g_get_monotonic_time();
+        for (int i = 0; i < BENCH_EQ_BUFFERS; i++) {
+            equalizer_process(&eq, samples, BENCH_EQ_FRAMES, simd);
+        }
+        us[simd] = (gdouble)(g_get_monotonic_time() - start) / BENCH_EQ_BUFFERS;
+
+        start = g_get_monotonic_time();
+        for (int i = 0; i < BENCH_EQ_BUFFERS; i++) {
+            memset(silence, 0, BENCH_EQ_FRAMES * 2 * sizeof(gfloat));
+            equalizer_process(&eq, silence, BENCH_EQ_FRAMES, simd);
+        }
+        silent_us[simd] = (gdouble)(g_get_monotonic_time() - start) / BENCH_EQ_BUFFERS;
+    }
+    g_free(samples);
+    g_free(silence);
+
+    gdouble buffer_us = BENCH_EQ_FRAMES * 1e6 / 44100.0;
+    gdouble best = us[1] >= 0 ? us[1] : us[0];
+    g_string_append_printf(out, "\"equalizer\": {\"preset\": \"%s\", \"channels\": 2, \"rate\": 44100, "
+                                "\"frames_per_buffer\": %d, ",
+                           eq_presets[preset].name, BENCH_EQ_FRAMES);
+    bench_append_ms(out, "scalar_us_per_buffer", us[0]);
+    g_string_append(out, ", ");
+    bench_append_ms(out, "simd_us_per_buffer", us[1]);
+    g_string_append(out, ", ");
+    bench_append_ms(out, "scalar_silent_us_per_buffer", silent_us[0]);
+    g_string_append(out, ", ");
+    bench_append_ms(out, "simd_silent_us_per_buffer", silent_us[1]);
+    g_string_append_printf(out, ", \"buffer_duration_us\": %.1f, \"cpu_fraction\": %.6f}",
+                           buffer_us, best / buffer_us);
+}
+
+#define BENCH_DUP_ENTRIES 100000 // Sentetik parmak izi sayısı
+#define BENCH_DUP_PLANTED 1000   // Bunların içine eklenen gürültülü kopya sayısı
+#define BENCH_DUP_NOISE   0.12   // Kopyalarda çevrilen bit oranı (FINGERPRINT_MAX_BER'e yakın)
+
+/* LSH kümelemesinin büyük kütüphanedeki süresi ve eklenen kopyaları bulma oranı */
+static void bench_duplicates(GString *out) {
+    guint n = BENCH_DUP_ENTRIES + BENCH_DUP_PLANTED;
+    FingerprintEntry *storage = g_new(FingerprintEntry, n);
+    FingerprintEntry **entries = g_new(FingerprintEntry *, n);
+    GRand *rand = g_rand_new_with_seed(42);
+
+    for (guint i = 0; i < BENCH_DUP_ENTRIES; i++) {
+        storage[i].path = NULL;
+        storage[i].duration = g_rand_int_range(rand, 120000, 360000);
+        storage[i].frames = FINGERPRINT_FRAMES;
+        for (int w = 0; w < FINGERPRINT_FRAMES; w++)
+            storage[i].words[w] = g_rand_int(rand);
+    }
+    // Kopyalar listenin sonunda; her biri rastgele bir özgün kaydın gürültülü hali
+    for (guint i = BENCH_DUP_ENTRIES; i < n; i++) {
+        storage[i] = storage[g_rand_int_range(rand, 0, BENCH_DUP_ENTRIES)];
+        for (int w = 0; w < FINGERPRINT_FRAMES; w++) {
+            for (int b = 0; b < 32; b++) {
+                if (g_rand_double(rand) < BENCH_DUP_NOISE)
+                    storage[i].words[w] ^= 1u << b;
+            }
+        }
+    }
+    for (guint i = 0; i < n; i++)
+        entries[i] = &storage[i];
+    g_rand_free(rand);
+
+    gint64 start = g_get_monotonic_time();
+    guint *root = fingerprint_cluster(entries, n);
+    gdouble cluster_ms = (g_get_monotonic_time() - start) / 1000.0;
+
+    guint found = 0, false_merges = 0;
+    for (guint i = 0; i < n; i++) {
+        if (i >= BENCH_DUP_ENTRIES && root[i] < BENCH_DUP_ENTRIES)
+            found++;
+        else if (i < BENCH_DUP_ENTRIES && root[i] != i)
+            false_merges++;
+    }
+    g_free(root);
+    g_free(entries);
+    g_free(storage);
+
+    g_string_append_printf(out, "\"duplicates\": {\"entries\": %u, \"planted\": %d, \"noise\": %.2f, "
+                                "\"found\": %u, \"recall\": %.3f, \"false_merges\": %u, ",
+                           n, BENCH_DUP_PLANTED, BENCH_DUP_NOISE, found,
+                           (gdouble)found / BENCH_DUP_PLANTED, false_merges);
+    bench_append_ms(out, "cluster_ms", cluster_ms);
+    g_string_append(out, "}");
+}
+
+static int run_benchmark(int argc, char **argv) {
+    const gchar *sizes_arg = "1000,10000,100000";
+    const gchar *sink_name = "fakesink";
+    const gchar *output_path = NULL;
+
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (g_str_equal(argv[i], "--sizes")) {
+            sizes_arg = argv[i + 1];
+        } else if (g_str_equal(argv[i], "--sink")) {
+            sink_name = argv[i + 1];
+        } else if (g_str_equal(argv[i], "--output")) {
+            output_path = argv[i + 1];
+        }
+    }
+
+    // Oynatıcının konsol çıktıları JSON'a karışmasın
+    g_set_print_handler(bench_silent_print);
+
+    PlayerData *data = player_new(sink_name);
+    if (!data)
+        return 1;
+    // Her next_media tam bir parça değişimi olsun; listenin sonunda başa dönülsün
+    data->gapless_enabled = FALSE;
+    data->loop_enabled = TRUE;
+
+    gboolean have_gtk = gtk_init_check(NULL, NULL);
+    if (have_gtk) {
+        GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        player_build_ui(data, window);
+        gtk_widget_show_all(window);
+        bench_pump_events();
+    }
+
+    // Sink pad'ine ölçüm probe'u
+    BenchProbe probe = { BENCH_PROBE_IDLE, 0 };
+    GstElement *audio_sink = NULL;
+    g_object_get(data->playbin, "audio-sink", &audio_sink, NULL);
+    if (audio_sink) {
+        // fakesink varsayılan olarak saatle eşlemez; eski parça sonuna kadar hızla akardı
+        if (g_object_class_find_property(G_OBJECT_GET_CLASS(audio_sink), "sync"))
+            g_object_set(audio_sink, "sync", TRUE, NULL);
+        GstPad *sink_pad = gst_element_get_static_pad(audio_sink, "sink");
+        gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+                          bench_probe_cb, &probe, NULL);
+        gst_object_unref(sink_pad);
+        gst_object_unref(audio_sink);
+    }
+
+    // Kısa ses dosyalarını üret
+    gchar *dir = g_dir_make_tmp("mp3_player_bench_XXXXXX", NULL);
+    if (!dir) {
+        g_printerr("Hata: Geçici klasör oluşturulamadı.\n");
+        return 1;
+    }
+    gchar *audio_files[BENCH_AUDIO_FILES];
+    for (int i = 0; i < BENCH_AUDIO_FILES; i++) {
+        gchar *name = g_strdup_printf("track%02d.wav", i);
+        audio_files[i] = g_build_filename(dir, name, NULL);
+        bench_write_wav(audio_files[i], 220.0 * (i + 1));
+        g_free(name);
+    }
+
+    GString *out = g_string_new(NULL);
+    g_string_append_printf(out, "{\n  \"benchmark\": \"mp3_player\",\n  \"sink\": \"%s\",\n"
+                                "  \"gtk\": %s,\n  \"iterations\": %d,\n  \"results\": [\n",
+                           sink_name, have_gtk ? "true" : "false", BENCH_ITERATIONS);
+
+    gchar **sizes = g_strsplit(sizes_arg, ",", -1);
+    gboolean first = TRUE;
+    for (int i = 0; sizes[i]; i++) {
+        int entries = (int)g_ascii_strtoll(sizes[i], NULL, 10);
+        if (entries <= 0)
+            continue;
+        if (!first)
+            g_string_append(out, ",\n");
+        first = FALSE;
+        bench_run_size(data, &probe, audio_files, entries, out);
+    }
+    g_strfreev(sizes);
+    g_string_append(out, "\n  ],\n  ");
+    bench_equalizer(out);
+    g_string_append(out, ",\n  ");
+    bench_duplicates(out);
+    g_string_append(out, "\n}\n");
+
+    if (output_path) {
+        g_file_set_contents(output_path, out->str, out->len, NULL);
+    } else {
+        fputs(out->str, stdout);
+    }
+
+    for (int i = 0; i < BENCH_AUDIO_FILES; i++) {
+        g_unlink(audio_files[i]);
+        g_free(audio_files[i]);
+    }
+    g_rmdir(dir);
+    g_free(dir);
+    g_string_free(out, TRUE);
+    stop_media(data);
+    player_control_shutdown(data);
+    gst_element_set_state(data->playbin, GST_STATE_NULL);
+    gst_object_unref(data->playbin);
+    return 0;
 }
 
 int main(int argc, char **argv) {
@@ -511,6 +7306,16 @@ int main(int argc, char **argv) {
     int status;
 
     gst_init(&argc, &argv);
+
+    // Headless mod: GTK hiç başlatılmaz
+    if (argc > 1 && g_str_equal(argv[1], "--headless")) {
+        return run_headless(argc - 2, argv + 2);
+    }
+
+    // Benchmark modu: sonuçlar JSON olarak yazılır
+    if (argc > 1 && g_str_equal(argv[1], "--bench")) {
+        return run_benchmark(argc - 2, argv + 2);
+    }
     app = gtk_application_new("com.example.mp3player", G_APPLICATION_DEFAULT_FLAGS);
 
     g_signal_connect(app, "activate", G_CALLBACK(activate), NULL);